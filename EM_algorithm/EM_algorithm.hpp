@@ -4,6 +4,7 @@
 #include <iostream>
 #include <deque>
 #include <array>
+#include <vector>
 #include <boost/numeric/ublas/lu.hpp>
 #include "statistic_util.hpp"
 #include "data_struct.hpp"
@@ -36,7 +37,12 @@ namespace EM {
 
         using ExRecord = std::tuple <std::array <double, mixture_num>, std::array <dvector <dim>, mixture_num>, std::array <dmatrix <dim>, mixture_num>, double >;
 
+        // データごと，分布ごとの中間生成物[t][dist]
+        // データ数が大きくてもスタックを溢れさせないようにヒープに置く．
+        using Table = std::vector <std::array <double, mixture_num> >;
+
         // パラメータを更新し，対数尤度を返す関数
+        // numがstatistic::DYNAMICのデータ列も受け付ける．
         template <int num>
         static boost::optional<ExRecord> update(const Record &record, const statistic::Data_series <dim, num> &data_series);
 
@@ -44,6 +50,12 @@ namespace EM {
         template <int num>
         static boost::optional<double> logL(const Record &record, const statistic::Data_series <dim, num> &data_series);
 
+        // 分布ごとの重み付き対数密度 logp[t][dist] = log(pi_dist) + log N(x_t | mu_dist, sigma_dist) を求める関数
+        // 分散が正定値でない，またはcheck_determinantのとき行列式がepsilon未満ならばfalse．
+        template <int num>
+        static bool log_weighted_densities(const std::array <double, mixture_num> &pi, const std::array <dvector <dim>, mixture_num> &mus, const std::array <dmatrix <dim>, mixture_num> &sigmas,
+                                           const statistic::Data_series <dim, num> &data_series, Table &logp, const bool check_determinant=true);
+
         // レコードを読み込む関数
         static Record input(std::istream &is, const char delim);
 
@@ -0,0 +1,162 @@
+#ifndef EM_BLOCKED
+#define EM_BLOCKED
+
+#include <array>
+#include <iostream>
+#include <Eigen/Dense>
+#include <boost/optional.hpp>
+#include "EM_algorithm.hpp"
+
+namespace EM {
+    // SoA形式のデータ行列
+    // 行がデータ，列が成分．列優先なので各成分が全データにわたって連続に並ぶ．
+    template <int dim>
+    using Data_matrix = Eigen::Matrix <double, Eigen::Dynamic, dim>;
+
+    // Data_seriesをSoA形式に詰め替える．numはstatistic::DYNAMICでもよい．
+    template <int dim, int num>
+    Data_matrix <dim> to_data_matrix(const statistic::Data_series <dim, num> &data_series);
+
+    // 混合正規分布の十分統計量
+    // データを分けて足し込んでいき，最後にM-stepでパラメータを得る．
+    template <int dim, int mixture_num>
+    struct Sufficient_statistics
+    {
+        using Estimator = EM_estimator <dim, statistic::GAUSSIAN_MIXTURES <mixture_num> >;
+        using ExRecord  = typename Estimator::ExRecord;
+        using Matrix    = Eigen::Matrix <double, dim, dim>;
+
+        long                                     num;       // 足し込んだデータ数
+        double                                   logL;      // 対数尤度
+        Eigen::Matrix <double, 1, mixture_num>   gammaSum;  // sum_t gamma[t][dist]
+        Eigen::Matrix <double, dim, mixture_num> sumvector; // sum_t gamma[t][dist] x_t
+        std::array <Matrix, mixture_num>         summatrix; // sum_t gamma[t][dist] x_t x_t^T（下三角のみ）
+
+        Sufficient_statistics();
+
+        void clear();
+
+        Sufficient_statistics&operator+=(const Sufficient_statistics &other);
+
+        // データ1個あたりに正規化してから (1 - eta) * this + eta * other と内分する．
+        // 結果はデータ1個あたりの統計量（num = 1）になる．
+        Sufficient_statistics&interpolate(const Sufficient_statistics &other, const double eta);
+
+        // M-step．パラメータと対数尤度を返す．
+        ExRecord record() const;
+    };
+
+    // データファイルをchunk_size行ずつSoA形式で読み込む
+    // ファイル全体をメモリに載せずにE-stepを回すために使う．
+    template <int dim>
+    class Chunk_reader
+    {
+    public:
+        Chunk_reader() = delete;
+        Chunk_reader(std::istream &datain, const statistic_util::FORMAT &format, const int chunk_size);
+        ~Chunk_reader() = default;
+
+        // 次のチャンクを読み込む．1行も読めなければfalse
+        bool next();
+
+        // ファイルの先頭に戻る
+        void rewind();
+
+        // 直前に読み込んだチャンク
+        Eigen::Ref <const Data_matrix <dim> > chunk() const;
+
+    private:
+        std::istream                  &_datain;
+        const statistic_util::FORMAT _format;
+        Data_matrix <dim>            _X;
+        int                          _rows; // _Xのうち読み込んだ行数
+    };
+
+    // 混合正規分布のEMアルゴリズムのブロック化版
+    // EM_estimator::update/logLと同じ値を返す．
+    // データをblock_size個ずつのブロックに分け，ブロックごとに
+    // (1) E-step : 反復ごとに分散のCholesky因子の逆行列L^-1を全成分ぶん並べた行列を作っておき，
+    //              ブロックと1回の行列積で全成分の白色化したデータ L^-1 (x - mu) を求める．
+    //              負担率は対数密度のままlog-sum-expで正規化する．
+    // (2) M-step : 負担率で重みを付けたデータとの内積で十分統計量を足し込む．
+    // 作業領域を持つのでインスタンスを作って使う．
+    template <int dim, int mixture_num>
+    class Blocked_EM_estimator
+    {
+    public:
+        using Estimator  = EM_estimator <dim, statistic::GAUSSIAN_MIXTURES <mixture_num> >;
+        using Record     = typename Estimator::Record;
+        using ExRecord   = typename Estimator::ExRecord;
+        using Statistics = Sufficient_statistics <dim, mixture_num>;
+        using Data_ref   = Eigen::Ref <const Data_matrix <dim> >;
+
+        // 1ブロックのデータ数．ブロックの作業領域がL1/L2に載る程度にする．
+        static int block_size;
+
+        // データを持たない推定器．Chunk_reader版かprepare/accumulateで使う．
+        Blocked_EM_estimator();
+        template <int num>
+        explicit Blocked_EM_estimator(const statistic::Data_series <dim, num> &data_series);
+        explicit Blocked_EM_estimator(const Data_matrix <dim> &X);
+        ~Blocked_EM_estimator() = default;
+
+        // パラメータを更新し，対数尤度を返す関数
+        boost::optional <ExRecord> update(const Record &record);
+
+        // 対数尤度を返す関数
+        boost::optional <double> logL(const Record &record);
+
+        // データファイルを先頭からチャンクごとに読み，十分統計量を足し込んで更新する関数
+        boost::optional <ExRecord> update(const Record &record, Chunk_reader <dim> &reader);
+
+        boost::optional <double> logL(const Record &record, Chunk_reader <dim> &reader);
+
+        // E-stepの準備として分散を分解する．
+        // 分散が正定値でない，またはcheck_determinantのとき行列式がepsilon未満ならばfalse．
+        bool prepare(const Record &record, const bool check_determinant=true);
+
+        // prepareの後，データXの負担率を求めて十分統計量に足し込む
+        void accumulate(const Data_ref &X, Statistics &stats);
+
+        // prepareの後，データXの対数尤度を返す
+        double accumulate_logL(const Data_ref &X);
+
+        const Data_matrix <dim>&data() const;
+
+    private:
+        using Vector = Eigen::Matrix <double, dim, 1>;
+        using Matrix = Eigen::Matrix <double, dim, dim>;
+        using Block  = Eigen::Matrix <double, Eigen::Dynamic, dim>;
+        using Whiten = Eigen::Matrix <double, dim, dim * mixture_num>;
+        using Shift  = Eigen::Matrix <double, 1, dim * mixture_num>;
+        using Zs     = Eigen::Matrix <double, Eigen::Dynamic, dim * mixture_num>;
+        using Resp   = Eigen::Matrix <double, Eigen::Dynamic, mixture_num>;
+
+        // ブロックXbについて log(pi_k) + log N(x_t | mu_k, sigma_k) を_Pに求める
+        void log_densities(const Data_ref &Xb);
+
+        // _Pの先頭size行について行ごとのlog-sum-expを_logLに求める
+        void logsumexp(const int size);
+
+        void resize_workspace();
+
+        Data_matrix <dim>                _X;
+        Whiten                           _A;        // [L_1^-T ... L_K^-T]．L_kは分散のCholesky因子（下三角）
+        Shift                            _b;        // [(L_1^-1 mu_1)^T ... (L_K^-1 mu_K)^T]
+        std::array <double, mixture_num> _logcoefs; // log(pi_k) - (dim / 2) log(2 pi) - (1 / 2) log|sigma_k|
+        // ブロックの作業領域
+        Zs                                       _D;    // 成分ごとに白色化したデータを横に並べたもの
+        Block                                    _W;    // 負担率で重みを付けたデータ
+        Resp                                     _P;    // 重み付き対数密度→負担率
+        Eigen::Array <double, Eigen::Dynamic, 1> _logL; // データごとの対数尤度
+        Eigen::Array <double, Eigen::Dynamic, 1> _sum;  // log-sum-expの途中の和
+    };
+
+    void test_EM_blocked();
+
+    void test_EM_chunked();
+}
+
+#include "detail/EM_blocked.hpp"
+
+#endif
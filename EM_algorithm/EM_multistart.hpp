@@ -0,0 +1,98 @@
+#ifndef EM_MULTISTART
+#define EM_MULTISTART
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/optional.hpp>
+#include "EM_blocked.hpp"
+#include "../lab/thread_pool.hpp"
+
+namespace EM {
+    // 1本のEMの終わり方
+    enum class CHAIN { SUCCESS, FAILED, DOMINATED };
+
+    // 1つの初期値から回したEMの結果
+    template <int dim, int mixture_num>
+    struct Chain_result
+    {
+        using Record = typename EM_estimator <dim, statistic::GAUSSIAN_MIXTURES <mixture_num> >::Record;
+
+        Record                    initial;      // 初期値
+        boost::optional <double>  initial_logL; // 初期対数尤度．初期から分散が正定値でなければnone
+        Record                    record;       // 最終値（DOMINATEDのときは打ち切った時点の値）
+        double                    logL;         // 最終対数尤度
+        int                       steps;        // ステップ数
+        CHAIN                     status;
+    };
+
+    // 多数の初期値からEMを並列に回す
+    // データはSoA形式で1つだけ持ち，全ワーカーで読み込み専用に共有する．
+    // ワーカーは未処理の初期値を1つずつ取っていくので，鎖の長さがばらついても負荷が偏らない．
+    // これまでに収束した鎖の最良の対数尤度より明らかに劣る鎖は途中で打ち切る．
+    // 打ち切るときは全ての鎖をdominance_interval歩ずつ進めては揃え，揃えた時点でだけ最良値の更新と判定をする．
+    // 鎖ごとの進み方はスケジューリングによらないので，結果はスレッド数によらず同じになる．
+    template <int dim, int mixture_num>
+    class Multi_start
+    {
+    public:
+        using Estimator = EM_estimator <dim, statistic::GAUSSIAN_MIXTURES <mixture_num> >;
+        using Record    = typename Estimator::Record;
+        using Result    = Chain_result <dim, mixture_num>;
+
+        // 停止判定（_test_EM_initial_valueと同じ）
+        static int    big_num;   // 無限ループストッパ
+        static int    least;     // 最低ステップ数
+        static double epsilon;   // パラメータと対数尤度の変化の許容量
+        // 打ち切り判定
+        // dominance_least歩以降，今の増分のままdominance_horizon歩進んでも
+        // 最良の対数尤度 - dominance_marginに届かない鎖を打ち切る．dominance_horizonが0のとき打ち切らない．
+        // 判定はdominance_interval歩ごとに全ての鎖を揃えてする．
+        static int    dominance_least;
+        static int    dominance_horizon;
+        static double dominance_margin;
+        static int    dominance_interval;
+
+        Multi_start() = delete;
+        template <int num>
+        explicit Multi_start(const statistic::Data_series <dim, num> &data_series);
+        ~Multi_start() = default;
+
+        // 初期値ごとの結果を初期値と同じ順に返す
+        std::vector <Result> run(const std::vector <Record> &initials, const int threads=parallel::hardware_threads()) const;
+
+        // _test_EM_initial_valueと同じ列に状態の列を加えて書き出す
+        static void output(std::ostream &os, const statistic_util::Header &header, const char delim);
+
+        static void output(std::ostream &os, const Result &result, const char delim);
+
+    private:
+        using Blocked = Blocked_EM_estimator <dim, mixture_num>;
+
+        // 途中の鎖．resultのrecord, logL, stepsは最後に進めた時点の値を持つ．
+        struct Chain
+        {
+            Result result;
+            double increment; // 最後の1歩での対数尤度の増分
+            bool   running;
+        };
+
+        // 初期対数尤度を求めて鎖を始める
+        Chain start_chain(const Record &initial, Blocked &estimator) const;
+
+        // 鎖を最大steps歩進める．収束するか失敗すればrunningをfalseにする．
+        void advance_chain(Chain &chain, const int steps, Blocked &estimator) const;
+
+        // 揃えた時点で，収束した鎖の最良の対数尤度bestより明らかに劣るか
+        bool dominated(const Chain &chain, const double best) const;
+
+        const Data_matrix <dim> _X;
+    };
+
+    void test_EM_initial_value_parallel(const std::string &numbering, const int threads=parallel::hardware_threads());
+}
+
+#include "detail/EM_multistart.hpp"
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef EM_ONLINE
+#define EM_ONLINE
+
+#include "EM_blocked.hpp"
+
+namespace EM {
+    // 混合正規分布のオンライン（ミニバッチ）EMアルゴリズム
+    // ミニバッチごとにE-stepを行い，データ1個あたりの十分統計量 s を
+    //     s <- (1 - eta_k) s + eta_k s_batch,  eta_k = (k + 1)^-alpha  (k = 0, 1, ...)
+    // と内分してからM-stepを行う．eta_0 = 1 なので最初のステップはミニバッチの統計量そのものになる．
+    // 0.5 < alpha <= 1 のとき sum eta_k = inf, sum eta_k^2 < inf（Robbins-Monroの条件）を満たし，
+    // 対数尤度の停留点に収束する．
+    // データ列全体を持たないので，ファイルや確率分布から流れてくるデータにそのまま使える．
+    template <int dim, int mixture_num>
+    class Online_EM_estimator
+    {
+    public:
+        using Estimator  = EM_estimator <dim, statistic::GAUSSIAN_MIXTURES <mixture_num> >;
+        using Record     = typename Estimator::Record;
+        using Statistics = Sufficient_statistics <dim, mixture_num>;
+        using Data_ref   = typename Blocked_EM_estimator <dim, mixture_num>::Data_ref;
+
+        // 学習率の減衰の指数
+        static double alpha;
+
+        Online_EM_estimator() = delete;
+        // batch_sizeは生成器から1ステップで引くデータ数
+        Online_EM_estimator(const Record &initial, const int batch_size);
+        ~Online_EM_estimator() = default;
+
+        // ミニバッチ1つでパラメータを更新する．分散が正定値でなくなればfalseを返し，パラメータは変えない．
+        bool step(const Data_ref &batch);
+
+        // 生成器 generate() -> dvector<dim> からbatch_size個引いて更新する
+        template <class Generator>
+        bool sample_step(Generator &&generate);
+
+        // データファイルをミニバッチごとにpasses周読んで更新する．失敗すればfalse
+        bool fit(Chunk_reader <dim> &reader, const int passes=1);
+
+        // 現在のパラメータ
+        const Record&record() const;
+
+        // これまでのステップ数
+        int steps() const;
+
+        // 直近のミニバッチのデータ1個あたりの対数尤度
+        double logL() const;
+
+    private:
+        Blocked_EM_estimator <dim, mixture_num> _estimator;
+        Record                                  _record;
+        Statistics                              _stats;  // データ1個あたりの十分統計量
+        Statistics                              _batch;
+        Data_matrix <dim>                       _buffer; // 生成器から引いたデータ
+        int                                     _steps;
+        double                                  _logL;
+    };
+
+    void test_EM_online();
+}
+
+#include "detail/EM_online.hpp"
+
+#endif
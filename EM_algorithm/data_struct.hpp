@@ -1,6 +1,7 @@
 #ifndef DATA_STRUCT
 #define DATA_STRUCT
 #include <iostream>
+#include <vector>
 #include "pdist.hpp"
 
 namespace statistic {
@@ -8,6 +9,9 @@ namespace statistic {
     template <int dim, class distribution>
     using PD = Probability_distribution<dim, distribution>;
 
+    // 要素数を実行時に決めるときのnum
+    constexpr int DYNAMIC = -1;
+
     template <int dim, int num> class Data_series;
 
     template <int dim, int num>
@@ -22,12 +26,36 @@ namespace statistic {
         void output(std::ostream& os, const statistic_util::FORMAT& format) const;  // ファイルに書き出す
 
         const std::array<dvector<dim>, num>& dataset() const;
+        int size() const;
     private:
         int _dim;
         int _num;
         std::array<dvector<dim>, num> _x;  // 次元はdim，要素数はnum
     };
 
+    // 要素数が実行時に決まるデータ列
+    // データはヒープに置くので，大きなデータでもスタックを溢れさせない．
+    template <int dim>
+    class Data_series<dim, DYNAMIC>
+    {
+    public:
+        Data_series() = delete;
+        Data_series(std::istream& datain, const statistic_util::FORMAT &format);  // ファイルから終端まで読み込む場合
+        template <class distribution>
+        Data_series(PD<dim, distribution>& pd, const int num);  // 生成器から作る場合
+
+        void output(std::ostream& os, const statistic_util::FORMAT& format) const;  // ファイルに書き出す
+
+        const std::vector<dvector<dim>>& dataset() const;
+        int size() const;
+    private:
+        std::vector<dvector<dim>> _x;  // 次元はdim
+    };
+
+    // データファイルから1行読み込む．読めなければfalse
+    template <int dim>
+    bool read_datum(std::istream& datain, const statistic_util::FORMAT &format, dvector<dim>& x);
+
     void test_data_series_gaussian();
     void test_data_series_gaussian_mixtures();
 
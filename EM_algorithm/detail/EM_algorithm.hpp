@@ -23,36 +23,21 @@ namespace EM {
         // sigmasの要素は参照になっている！
         static_assert(std::is_same <decltype(sigmas[0]), dmatrix <dim>&>::value, "tuple type check error!");
 
-        // 中間生成物p[t][dist]
-        util::multi_array <double, num, mixture_num> p;
-        dvector <dim>                                mu;
-        dmatrix <dim>                                sigmaInverse;
-        double                                       sigmaDeterminant;
-        for (int dist = 0; dist < mixture_num; dist++) {
-            mu = mus[dist];
-            if (const auto inv = statistic_util::invert <dim>(sigmas[dist])) {
-                sigmaInverse = *inv;
-            } else {
-                // 分散が正則でない．
-                return boost::none;
-            }
-            if (fabs(sigmaDeterminant = statistic_util::determinant <dim>(sigmas[dist])) < statistic_util::epsilon) {
-                return boost::none;
-            }
-            for (int t = 0; t < num; t++) {
-                p[t][dist] = statistic_util::pnorm <dim>(data_series.dataset()[t], mu, sigmaInverse, sigmaDeterminant);
-            }
+        // 中間生成物logp[t][dist] = log(pi * p)
+        // 密度は対数のまま扱い，負担率はlog-sum-expで正規化する．
+        const int size = data_series.size();
+        Table     logp(size);
+        if (!log_weighted_densities <num>(pi, mus, sigmas, data_series, logp)) {
+            return boost::none;
         }
 
-        // 中間生成物gamma[t][dist]
-        util::multi_array <double, num, mixture_num> gamma;
-        for (int t = 0; t < num; t++) {
-            double denominator = 0.;
-            for (int dist = 0; dist < mixture_num; dist++) {
-                denominator += pi[dist] * p[t][dist];
-            }
+        // 中間生成物gamma[t][dist]とデータごとの対数尤度logL_par_data[t]
+        Table                gamma(size);
+        std::vector <double> logL_par_data(size);
+        for (int t = 0; t < size; t++) {
+            logL_par_data[t] = statistic_util::logsumexp(logp[t]);
             for (int dist = 0; dist < mixture_num; dist++) {
-                gamma[t][dist] = pi[dist] * p[t][dist] / denominator;
+                gamma[t][dist] = exp(logp[t][dist] - logL_par_data[t]);
             }
         }
 
@@ -60,7 +45,7 @@ namespace EM {
         std::array <double, mixture_num> gammaSum;
         for (int dist = 0; dist < mixture_num; dist++) {
             double sum = 0.;
-            for (int t = 0; t < num; t++) {
+            for (int t = 0; t < size; t++) {
                 sum += gamma[t][dist];
             }
             gammaSum[dist] = sum;
@@ -71,15 +56,15 @@ namespace EM {
         // 混合率_pi
         std::array <double, mixture_num> new_pi;
         for (int dist = 0; dist < mixture_num; dist++) {
-            new_pi[dist] = gammaSum[dist] / num;
+            new_pi[dist] = gammaSum[dist] / size;
         }
 
         // 平均_mu
         std::array <dvector <dim>, mixture_num> new_mus;
         dvector <dim>                           sumvector;
         for (int dist = 0; dist < mixture_num; dist++) {
-            sumvector = dvector <dim>();
-            for (int t = 0; t < num; t++) {
+            sumvector = ublas::zero_vector <double>(dim);
+            for (int t = 0; t < size; t++) {
                 sumvector += gamma[t][dist] * data_series.dataset()[t];
             }
             new_mus[dist] = sumvector / gammaSum[dist];
@@ -89,8 +74,8 @@ namespace EM {
         std::array <dmatrix <dim>, mixture_num> new_sigmas;
         dmatrix <dim>                           summatrix;
         for (int dist = 0; dist < mixture_num; dist++) {
-            summatrix = dmatrix <dim>();
-            for (int t = 0; t < num; t++) {
+            summatrix = ublas::zero_matrix <double>(dim, dim);
+            for (int t = 0; t < size; t++) {
                 summatrix += gamma[t][dist] * ublas::outer_prod(data_series.dataset()[t], data_series.dataset()[t]);
             }
             new_sigmas[dist] = summatrix / gammaSum[dist] - ublas::outer_prod(new_mus[dist], new_mus[dist]);
@@ -100,13 +85,8 @@ namespace EM {
         // データごとの対数尤度の和を求める．
         double logL;
         double sum_of_logL = 0.;
-        for (int t = 0; t < num; t++) {
-            // データごとの，分布ごとの尤度の和を求める．
-            double sum_of_L_par_data = 0.;
-            for (int dist = 0; dist < mixture_num; dist++) {
-                sum_of_L_par_data += pi[dist] * p[t][dist];
-            }
-            sum_of_logL += log(sum_of_L_par_data);
+        for (int t = 0; t < size; t++) {
+            sum_of_logL += logL_par_data[t];
         }
 
         logL = sum_of_logL;
@@ -128,36 +108,20 @@ namespace EM {
         // sigmasの要素は参照になっている！
         static_assert(std::is_same <decltype(sigmas[0]), dmatrix <dim>&>::value, "tuple type check error!");
 
-        // 中間生成物p[t][dist]
-        util::multi_array <double, num, mixture_num> p;
-        dvector <dim>                                mu;
-        dmatrix <dim>                                sigmaInverse;
-        double                                       sigmaDeterminant;
-        for (int dist = 0; dist < mixture_num; dist++) {
-            mu = mus[dist];
-            if (const auto inv = statistic_util::invert <dim>(sigmas[dist])) {
-                sigmaInverse = *inv;
-            } else {
-                // 分散が正則でない．
-                return boost::none;
-            }
-            sigmaDeterminant = statistic_util::determinant <dim>(sigmas[dist]);
-            for (int t = 0; t < num; t++) {
-                p[t][dist] = statistic_util::pnorm <dim>(data_series.dataset()[t], mu, sigmaInverse, sigmaDeterminant);
-            }
+        // 中間生成物logp[t][dist] = log(pi * p)
+        const int size = data_series.size();
+        Table     logp(size);
+        if (!log_weighted_densities <num>(pi, mus, sigmas, data_series, logp, false)) {
+            return boost::none;
         }
 
         // 対数尤度_logL
         // データごとの対数尤度の和を求める．
         double logL;
         double sum_of_logL = 0.;
-        for (int t = 0; t < num; t++) {
-            // データごとの，分布ごとの尤度の和を求める．
-            double sum_of_L_par_data = 0.;
-            for (int dist = 0; dist < mixture_num; dist++) {
-                sum_of_L_par_data += pi[dist] * p[t][dist];
-            }
-            sum_of_logL += log(sum_of_L_par_data);
+        for (int t = 0; t < size; t++) {
+            // データごとの，分布ごとの尤度の和をlog-sum-expで求める．
+            sum_of_logL += statistic_util::logsumexp(logp[t]);
         }
 
         logL = sum_of_logL;
@@ -165,6 +129,35 @@ namespace EM {
         return logL;
     }
 
+    template <int dim, int mixture_num>
+    template <int num>
+    bool EM_estimator <dim, statistic::GAUSSIAN_MIXTURES <mixture_num> >::log_weighted_densities(const std::array <double, mixture_num> &pi, const std::array <dvector <dim>, mixture_num> &mus, const std::array <dmatrix <dim>, mixture_num> &sigmas,
+                                                                                             const statistic::Data_series <dim, num> &data_series, Table &logp, const bool check_determinant)
+    {
+        // 分散ごとにCholesky分解を1回だけ行い，対数行列式もその対角から得る．
+        const int     size = data_series.size();
+        dmatrix <dim> L;
+        double        logDeterminant;
+        for (int dist = 0; dist < mixture_num; dist++) {
+            if (const auto chol = statistic_util::cholesky <dim>(sigmas[dist])) {
+                L = *chol;
+            } else {
+                // 分散が正定値でない．
+                return false;
+            }
+            logDeterminant = statistic_util::log_determinant <dim>(L);
+            if (check_determinant && logDeterminant < log(statistic_util::epsilon)) {
+                return false;
+            }
+            const double logpi = log(pi[dist]);
+            for (int t = 0; t < size; t++) {
+                logp[t][dist] = logpi + statistic_util::log_pnorm <dim>(data_series.dataset()[t], mus[dist], L, logDeterminant);
+            }
+        }
+
+        return true;
+    }
+
     template <int dim, int mixture_num>
     typename EM_estimator <dim, statistic::GAUSSIAN_MIXTURES <mixture_num> >::Record EM_estimator <dim, statistic::GAUSSIAN_MIXTURES <mixture_num> >::input(std::istream &is, const char delim)
     {
@@ -0,0 +1,481 @@
+#ifndef DETAIL_EM_BLOCKED
+#define DETAIL_EM_BLOCKED
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include "../EM_blocked.hpp"
+
+namespace EM {
+    template <int dim, int num>
+    Data_matrix <dim> to_data_matrix(const statistic::Data_series <dim, num> &data_series)
+    {
+        const int         size = data_series.size();
+        Data_matrix <dim> X(size, dim);
+        for (int t = 0; t < size; t++) {
+            for (int i = 0; i < dim; i++) {
+                X(t, i) = data_series.dataset()[t](i);
+            }
+        }
+
+        return X;
+    }
+
+    template <int dim, int mixture_num>
+    Sufficient_statistics <dim, mixture_num>::Sufficient_statistics()
+    {
+        clear();
+    }
+
+    template <int dim, int mixture_num>
+    void Sufficient_statistics <dim, mixture_num>::clear()
+    {
+        num  = 0;
+        logL = 0.;
+        gammaSum.setZero();
+        sumvector.setZero();
+        for (auto &S : summatrix) {
+            S.setZero();
+        }
+    }
+
+    template <int dim, int mixture_num>
+    Sufficient_statistics <dim, mixture_num>&Sufficient_statistics <dim, mixture_num>::operator+=(const Sufficient_statistics &other)
+    {
+        num       += other.num;
+        logL      += other.logL;
+        gammaSum  += other.gammaSum;
+        sumvector += other.sumvector;
+        for (int dist = 0; dist < mixture_num; dist++) {
+            summatrix[dist] += other.summatrix[dist];
+        }
+
+        return *this;
+    }
+
+    template <int dim, int mixture_num>
+    Sufficient_statistics <dim, mixture_num>&Sufficient_statistics <dim, mixture_num>::interpolate(const Sufficient_statistics &other, const double eta)
+    {
+        const double a = (num > 0) ? (1. - eta) / num : 0.;
+        const double b = eta / other.num;
+        num       = 1;
+        logL      = a * logL + b * other.logL;
+        gammaSum  = a * gammaSum + b * other.gammaSum;
+        sumvector = a * sumvector + b * other.sumvector;
+        for (int dist = 0; dist < mixture_num; dist++) {
+            summatrix[dist] = a * summatrix[dist] + b * other.summatrix[dist];
+        }
+
+        return *this;
+    }
+
+    template <int dim, int mixture_num>
+    typename Sufficient_statistics <dim, mixture_num>::ExRecord Sufficient_statistics <dim, mixture_num>::record() const
+    {
+        std::array <double, mixture_num>        new_pi;
+        std::array <dvector <dim>, mixture_num> new_mus;
+        std::array <dmatrix <dim>, mixture_num> new_sigmas;
+        for (int dist = 0; dist < mixture_num; dist++) {
+            new_pi[dist] = gammaSum(dist) / num;
+            const Eigen::Matrix <double, dim, 1> mu    = sumvector.col(dist) / gammaSum(dist);
+            const Matrix                         sigma = Matrix(summatrix[dist].template selfadjointView <Eigen::Lower>()) / gammaSum(dist) - mu * mu.transpose();
+            for (int i = 0; i < dim; i++) {
+                new_mus[dist](i) = mu(i);
+                for (int j = 0; j < dim; j++) {
+                    new_sigmas[dist](i, j) = sigma(i, j);
+                }
+            }
+        }
+
+        return std::make_tuple(new_pi, new_mus, new_sigmas, logL);
+    }
+
+    template <int dim>
+    Chunk_reader <dim>::Chunk_reader(std::istream &datain, const statistic_util::FORMAT &format, const int chunk_size)
+        : _datain(datain), _format(format), _X(std::max(chunk_size, 1), dim), _rows(0)
+    {
+    }
+
+    template <int dim>
+    bool Chunk_reader <dim>::next()
+    {
+        dvector <dim> x;
+        _rows = 0;
+        while (_rows < _X.rows() && statistic::read_datum <dim>(_datain, _format, x)) {
+            for (int i = 0; i < dim; i++) {
+                _X(_rows, i) = x(i);
+            }
+            _rows++;
+        }
+
+        return _rows > 0;
+    }
+
+    template <int dim>
+    void Chunk_reader <dim>::rewind()
+    {
+        _datain.clear();
+        _datain.seekg(0);
+        _rows = 0;
+    }
+
+    template <int dim>
+    Eigen::Ref <const Data_matrix <dim> > Chunk_reader <dim>::chunk() const
+    {
+        return _X.topRows(_rows);
+    }
+
+    template <int dim, int mixture_num>
+    int Blocked_EM_estimator <dim, mixture_num>::block_size = 256;
+
+    template <int dim, int mixture_num>
+    Blocked_EM_estimator <dim, mixture_num>::Blocked_EM_estimator()
+        : _X(0, dim)
+    {
+        resize_workspace();
+    }
+
+    template <int dim, int mixture_num>
+    template <int num>
+    Blocked_EM_estimator <dim, mixture_num>::Blocked_EM_estimator(const statistic::Data_series <dim, num> &data_series)
+        : _X(to_data_matrix(data_series))
+    {
+        resize_workspace();
+    }
+
+    template <int dim, int mixture_num>
+    Blocked_EM_estimator <dim, mixture_num>::Blocked_EM_estimator(const Data_matrix <dim> &X)
+        : _X(X)
+    {
+        resize_workspace();
+    }
+
+    template <int dim, int mixture_num>
+    void Blocked_EM_estimator <dim, mixture_num>::resize_workspace()
+    {
+        const int rows = std::max(block_size, 1);
+        _D.resize(rows, dim * mixture_num);
+        _W.resize(rows, dim);
+        _P.resize(rows, mixture_num);
+        _logL.resize(rows);
+        _sum.resize(rows);
+    }
+
+    template <int dim, int mixture_num>
+    const Data_matrix <dim>&Blocked_EM_estimator <dim, mixture_num>::data() const
+    {
+        return _X;
+    }
+
+    template <int dim, int mixture_num>
+    bool Blocked_EM_estimator <dim, mixture_num>::prepare(const Record &record, const bool check_determinant)
+    {
+        const auto &pi     = std::get <0>(record);
+        const auto &mus    = std::get <1>(record);
+        const auto &sigmas = std::get <2>(record);
+
+        Vector mu;
+        Matrix sigma;
+        for (int dist = 0; dist < mixture_num; dist++) {
+            for (int i = 0; i < dim; i++) {
+                mu(i) = mus[dist](i);
+                for (int j = 0; j < dim; j++) {
+                    sigma(i, j) = sigmas[dist](i, j);
+                }
+            }
+            // 負担率の和が0になった分布は平均も分散もNaNになる．LLTはNaNを通すので先に弾く．
+            if (!sigma.allFinite() || !mu.allFinite()) {
+                return false;
+            }
+            Eigen::LLT <Matrix> llt(sigma);
+            if (llt.info() != Eigen::Success) {
+                // 分散が正定値でない．
+                return false;
+            }
+            // データ点ごとの三角求解をやめ，逆行列を反復ごとに1回だけ作る．
+            const Matrix L    = llt.matrixL();
+            const Matrix Linv = L.template triangularView <Eigen::Lower>().solve(Matrix::Identity());
+            _A.template middleCols <dim>(dist * dim) = Linv.transpose();
+            _b.template segment <dim>(dist * dim)    = (Linv * mu).transpose();
+            const double logDeterminant = 2. * L.diagonal().array().log().sum();
+            // EM_estimator::updateと同じ判定
+            if (check_determinant && logDeterminant < log(statistic_util::epsilon)) {
+                return false;
+            }
+            _logcoefs[dist] = log(pi[dist]) + statistic_util::log_normalize <dim>() - 0.5 * logDeterminant;
+        }
+        if (_P.rows() != std::max(block_size, 1)) {
+            resize_workspace();
+        }
+
+        return true;
+    }
+
+    template <int dim, int mixture_num>
+    void Blocked_EM_estimator <dim, mixture_num>::log_densities(const Data_ref &Xb)
+    {
+        const int size = Xb.rows();
+        auto      D    = _D.topRows(size);
+        auto      P    = _P.topRows(size);
+        // 各行を成分ごとの L^-1 x - L^-1 mu にする．D <- Xb [L_1^-T ... L_K^-T] - b
+        D.noalias() = Xb.lazyProduct(_A);
+        D.rowwise() -= _b;
+        // 行ごとの縮約は列優先の行列ではベクトル化されないので，列を足し込む．
+        for (int dist = 0; dist < mixture_num; dist++) {
+            auto p = P.col(dist).array();
+            p = D.col(dist * dim).array().square();
+            for (int i = 1; i < dim; i++) {
+                p += D.col(dist * dim + i).array().square();
+            }
+            p = _logcoefs[dist] - 0.5 * p;
+        }
+    }
+
+    template <int dim, int mixture_num>
+    void Blocked_EM_estimator <dim, mixture_num>::logsumexp(const int size)
+    {
+        auto P = _P.topRows(size);
+        auto m = _logL.head(size);
+        auto s = _sum.head(size);
+        // 行ごとの最大値を括り出す．すべて-infの行はそのまま-infにする．
+        // log_densitiesと同じく列ごとに処理する．
+        m = P.col(0).array();
+        for (int dist = 1; dist < mixture_num; dist++) {
+            m = m.max(P.col(dist).array());
+        }
+        s.setZero();
+        for (int dist = 0; dist < mixture_num; dist++) {
+            s += (P.col(dist).array() - m).exp();
+        }
+        m = (m.isInf()).select(m, m + s.log());
+    }
+
+    template <int dim, int mixture_num>
+    void Blocked_EM_estimator <dim, mixture_num>::accumulate(const Data_ref &X, Statistics &stats)
+    {
+        const int num = X.rows();
+        for (int first = 0; first < num; first += block_size) {
+            const int size = std::min(block_size, num - first);
+            const auto Xb  = X.middleRows(first, size);
+            log_densities(Xb);
+            logsumexp(size);
+
+            // E-step
+            auto P = _P.topRows(size);
+            stats.logL += _logL.head(size).sum();
+            P           = (P.array().colwise() - _logL.head(size)).exp().matrix();
+
+            // M-stepのための十分統計量
+            stats.gammaSum.noalias()  += P.colwise().sum();
+            stats.sumvector.noalias() += Xb.transpose().lazyProduct(P);
+            auto W = _W.topRows(size);
+            for (int dist = 0; dist < mixture_num; dist++) {
+                W = Xb.array().colwise() * P.col(dist).array();
+                // 下三角の各要素をブロック方向の内積として求める．小さいdimではrank-k更新を呼ぶより速い．
+                stats.summatrix[dist].template triangularView <Eigen::Lower>() += W.transpose().lazyProduct(Xb);
+            }
+        }
+        stats.num += num;
+    }
+
+    template <int dim, int mixture_num>
+    double Blocked_EM_estimator <dim, mixture_num>::accumulate_logL(const Data_ref &X)
+    {
+        const int num         = X.rows();
+        double    sum_of_logL = 0.;
+        for (int first = 0; first < num; first += block_size) {
+            const int size = std::min(block_size, num - first);
+            log_densities(X.middleRows(first, size));
+            logsumexp(size);
+            sum_of_logL += _logL.head(size).sum();
+        }
+
+        return sum_of_logL;
+    }
+
+    template <int dim, int mixture_num>
+    boost::optional <typename Blocked_EM_estimator <dim, mixture_num>::ExRecord> Blocked_EM_estimator <dim, mixture_num>::update(const Record &record)
+    {
+        if (!prepare(record, true)) {
+            return boost::none;
+        }
+        Statistics stats;
+        accumulate(_X, stats);
+
+        return stats.record();
+    }
+
+    template <int dim, int mixture_num>
+    boost::optional <double> Blocked_EM_estimator <dim, mixture_num>::logL(const Record &record)
+    {
+        if (!prepare(record, false)) {
+            return boost::none;
+        }
+
+        return accumulate_logL(_X);
+    }
+
+    template <int dim, int mixture_num>
+    boost::optional <typename Blocked_EM_estimator <dim, mixture_num>::ExRecord> Blocked_EM_estimator <dim, mixture_num>::update(const Record &record, Chunk_reader <dim> &reader)
+    {
+        if (!prepare(record, true)) {
+            return boost::none;
+        }
+        Statistics stats;
+        reader.rewind();
+        while (reader.next()) {
+            accumulate(reader.chunk(), stats);
+        }
+        if (stats.num == 0) {
+            return boost::none;
+        }
+
+        return stats.record();
+    }
+
+    template <int dim, int mixture_num>
+    boost::optional <double> Blocked_EM_estimator <dim, mixture_num>::logL(const Record &record, Chunk_reader <dim> &reader)
+    {
+        if (!prepare(record, false)) {
+            return boost::none;
+        }
+        double sum_of_logL = 0.;
+        reader.rewind();
+        while (reader.next()) {
+            sum_of_logL += accumulate_logL(reader.chunk());
+        }
+
+        return sum_of_logL;
+    }
+
+    // ublas版とブロック化版で同じ初期値から最大1000ステップ回し，結果と時間を比べる．
+    void test_EM_blocked()
+    {
+        constexpr int dim         = DIM;
+        constexpr int mixture_num = MIXTURE_NUM;
+        constexpr int num         = NUM;
+        using DS = statistic::Data_series <dim, num>;
+        constexpr statistic_util::FORMAT format = statistic_util::FORMAT::CSV_COMMA;
+        constexpr char                   delim  = formatToDelim(format);
+        using EM      = EM_estimator <dim, statistic::GAUSSIAN_MIXTURES <mixture_num> >;
+        using Blocked = Blocked_EM_estimator <dim, mixture_num>;
+        using Record  = EM::Record;
+        constexpr int steps  = 1000;
+        constexpr int trials = 10;
+
+        std::ifstream fin("data03/square" + std::to_string(num) + ".dataset");
+        DS            ds(fin, format);
+        fin.close();
+
+        Blocked blocked(ds);
+
+        Record                                  record;
+        double                                  logL;
+        int                                     step;
+        std::array <double, mixture_num>        tmp_pi;
+        std::array <dvector <dim>, mixture_num> tmp_mus;
+        std::array <dmatrix <dim>, mixture_num> tmp_sigmas;
+
+        const auto run = [&](const Record &initial, const std::function <boost::optional <EM::ExRecord>(const Record&)> &update) {
+                             record = initial;
+                             logL   = 0.;
+                             const auto start = std::chrono::steady_clock::now();
+                             for (step = 0; step < steps; step++) {
+                                 if (auto tmp = update(record)) {
+                                     std::tie(tmp_pi, tmp_mus, tmp_sigmas, logL) = *tmp;
+                                     record                                      = std::make_tuple(tmp_pi, tmp_mus, tmp_sigmas);
+                                 } else {
+                                     break;
+                                 }
+                             }
+
+                             return std::chrono::duration_cast <std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+                         };
+
+        fin.open("data03/square_initial01.csv");
+        for (int trial = 0; trial < trials && !fin.eof(); trial++) {
+            const Record initial    = EM::input(fin, delim);
+            const auto   time_ublas = run(initial, [&ds](const Record &r) {
+                                              return EM::update(r, ds);
+                                          });
+            const Record record_ublas = record;
+            const double logL_ublas   = logL;
+            const int    step_ublas   = step;
+            const auto   time_blocked = run(initial, [&blocked](const Record &r) {
+                                                return blocked.update(r);
+                                            });
+
+            double diff = 0.;
+            for (int dist = 0; dist < mixture_num; dist++) {
+                diff = std::max(diff, fabs(std::get <0>(record)[dist] - std::get <0>(record_ublas)[dist]));
+                diff = std::max(diff, matrix_util::d_inf(std::get <1>(record)[dist], std::get <1>(record_ublas)[dist]));
+                diff = std::max(diff, matrix_util::d_inf(std::get <2>(record)[dist], std::get <2>(record_ublas)[dist]));
+            }
+
+            std::cout << "initial : " << trial << std::endl;
+            std::cout << "ublas   : " << step_ublas << " steps, " << time_ublas << "us, logL = " << logL_ublas << std::endl;
+            std::cout << "blocked : " << step << " steps, " << time_blocked << "us, logL = " << logL << std::endl;
+            std::cout << "max diff : " << diff << std::endl;
+        }
+        fin.close();
+    }
+
+    // 要素数を実行時に決めたデータ列と，ファイルをチャンクごとに読む版とで結果を比べる．
+    void test_EM_chunked()
+    {
+        constexpr int dim         = DIM;
+        constexpr int mixture_num = MIXTURE_NUM;
+        using DS = statistic::Data_series <dim, statistic::DYNAMIC>;
+        constexpr statistic_util::FORMAT format = statistic_util::FORMAT::CSV_COMMA;
+        constexpr char                   delim  = formatToDelim(format);
+        using EM      = EM_estimator <dim, statistic::GAUSSIAN_MIXTURES <mixture_num> >;
+        using Blocked = Blocked_EM_estimator <dim, mixture_num>;
+        using Record  = EM::Record;
+        constexpr int steps      = 100;
+        constexpr int chunk_size = 100;
+
+        const std::string filename = "data03/square1000.dataset";
+        std::ifstream     fin(filename);
+        DS                ds(fin, format);
+        fin.close();
+        std::cout << "num : " << ds.size() << std::endl;
+
+        fin.open("data03/square_initial01.csv");
+        Record initial = EM::input(fin, delim);
+        fin.close();
+
+        Blocked               blocked;
+        std::ifstream         datain(filename);
+        Chunk_reader <dim>    reader(datain, format, chunk_size);
+        Record                record_ublas = initial, record_chunked = initial;
+        double                logL_ublas   = 0., logL_chunked = 0.;
+        double                diff         = 0.;
+        int                   step;
+        for (step = 0; step < steps; step++) {
+            const auto up_ublas   = EM::update(record_ublas, ds);
+            const auto up_chunked = blocked.update(record_chunked, reader);
+            if (!up_ublas || !up_chunked) {
+                break;
+            }
+            std::array <double, mixture_num>        tmp_pi;
+            std::array <dvector <dim>, mixture_num> tmp_mus;
+            std::array <dmatrix <dim>, mixture_num> tmp_sigmas;
+            std::tie(tmp_pi, tmp_mus, tmp_sigmas, logL_ublas) = *up_ublas;
+            record_ublas                                      = std::make_tuple(tmp_pi, tmp_mus, tmp_sigmas);
+            std::tie(tmp_pi, tmp_mus, tmp_sigmas, logL_chunked) = *up_chunked;
+            record_chunked                                      = std::make_tuple(tmp_pi, tmp_mus, tmp_sigmas);
+        }
+        for (int dist = 0; dist < mixture_num; dist++) {
+            diff = std::max(diff, fabs(std::get <0>(record_chunked)[dist] - std::get <0>(record_ublas)[dist]));
+            diff = std::max(diff, matrix_util::d_inf(std::get <1>(record_chunked)[dist], std::get <1>(record_ublas)[dist]));
+            diff = std::max(diff, matrix_util::d_inf(std::get <2>(record_chunked)[dist], std::get <2>(record_ublas)[dist]));
+        }
+        std::cout << "steps : " << step << std::endl;
+        std::cout << "ublas   : logL = " << logL_ublas << std::endl;
+        std::cout << "chunked : logL = " << logL_chunked << std::endl;
+        std::cout << "max diff : " << diff << std::endl;
+    }
+}
+
+#endif
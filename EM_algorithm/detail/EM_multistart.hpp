@@ -0,0 +1,302 @@
+#ifndef DETAIL_EM_MULTISTART
+#define DETAIL_EM_MULTISTART
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include "../EM_multistart.hpp"
+
+namespace EM {
+    template <int dim, int mixture_num>
+    int Multi_start <dim, mixture_num>::big_num = 1e6;
+
+    template <int dim, int mixture_num>
+    int Multi_start <dim, mixture_num>::least = 0;
+
+    template <int dim, int mixture_num>
+    double Multi_start <dim, mixture_num>::epsilon = statistic_util::epsilon;
+
+    template <int dim, int mixture_num>
+    int Multi_start <dim, mixture_num>::dominance_least = 10;
+
+    template <int dim, int mixture_num>
+    int Multi_start <dim, mixture_num>::dominance_horizon = 100;
+
+    template <int dim, int mixture_num>
+    double Multi_start <dim, mixture_num>::dominance_margin = 10.;
+
+    template <int dim, int mixture_num>
+    int Multi_start <dim, mixture_num>::dominance_interval = 10;
+
+    template <int dim, int mixture_num>
+    template <int num>
+    Multi_start <dim, mixture_num>::Multi_start(const statistic::Data_series <dim, num> &data_series)
+        : _X(to_data_matrix(data_series))
+    {
+    }
+
+    template <int dim, int mixture_num>
+    std::vector <typename Multi_start <dim, mixture_num>::Result> Multi_start <dim, mixture_num>::run(const std::vector <Record> &initials, const int threads) const
+    {
+        const int            n = initials.size();
+        std::vector <Chain>  chains(n);
+        std::vector <int>    running(n);
+        for (int i = 0; i < n; i++) {
+            running[i] = i;
+        }
+        // 打ち切らないときは揃えずに最後まで回す
+        const int interval = (dominance_horizon > 0) ? std::max(dominance_interval, 1) : std::numeric_limits <int>::max();
+        double    best     = -std::numeric_limits <double>::infinity();
+
+        // 呼び出し元スレッドも1つのワーカーになる．作業領域はワーカーごとに持つ．
+        const int                         workers = std::max(std::min(threads, n), 1);
+        std::vector <Blocked>             estimators(workers);
+        parallel::Thread_pool             pool(workers - 1);
+        std::vector <std::future <void> > futures;
+        for (bool first = true; !running.empty(); first = false) {
+            // 各ワーカーは次の鎖を取ってはinterval歩進める．
+            std::atomic <int> next(0);
+            const int         m    = running.size();
+            const auto        work = [&](Blocked &estimator) {
+                                         for (int i; (i = next++) < m; ) {
+                                             Chain &chain = chains[running[i]];
+                                             if (first) {
+                                                 chain = start_chain(initials[running[i]], estimator);
+                                             }
+                                             if (chain.running) {
+                                                 advance_chain(chain, interval, estimator);
+                                             }
+                                         }
+                                     };
+            futures.clear();
+            for (int w = 1; w < workers; w++) {
+                futures.push_back(pool.submit([&work, &estimators, w]() {
+                                                  work(estimators[w]);
+                                              }));
+            }
+            work(estimators[0]);
+            for (auto &future : futures) {
+                future.get();
+            }
+
+            // 揃えた時点で，これまでに収束した鎖で最良値を更新してから打ち切る．
+            // 収束した鎖だけが最良値を更新する．退化しかけた鎖の発散する対数尤度で他を打ち切らないため．
+            for (const int i : running) {
+                if (chains[i].result.status == CHAIN::SUCCESS) {
+                    best = std::max(best, chains[i].result.logL);
+                }
+            }
+            std::vector <int> rest;
+            for (const int i : running) {
+                if (!chains[i].running) {
+                    continue;
+                }
+                if (dominated(chains[i], best)) {
+                    chains[i].result.status = CHAIN::DOMINATED;
+                    chains[i].running       = false;
+                    continue;
+                }
+                rest.push_back(i);
+            }
+            running.swap(rest);
+        }
+
+        std::vector <Result> results;
+        results.reserve(n);
+        for (auto &chain : chains) {
+            results.push_back(std::move(chain.result));
+        }
+
+        return results;
+    }
+
+    template <int dim, int mixture_num>
+    typename Multi_start <dim, mixture_num>::Chain Multi_start <dim, mixture_num>::start_chain(const Record &initial, Blocked &estimator) const
+    {
+        Chain chain;
+        chain.result.initial = initial;
+        chain.result.record  = initial;
+        chain.result.logL    = 0.;
+        chain.result.steps   = 0;
+        chain.result.status  = CHAIN::FAILED;
+        chain.increment      = 0.;
+        chain.running        = false;
+
+        // 初期対数尤度
+        if (!estimator.prepare(initial, false)) {
+            return chain;
+        }
+        chain.result.initial_logL = estimator.accumulate_logL(_X);
+        chain.result.logL         = *chain.result.initial_logL;
+        chain.running             = true;
+
+        return chain;
+    }
+
+    template <int dim, int mixture_num>
+    void Multi_start <dim, mixture_num>::advance_chain(Chain &chain, const int steps, Blocked &estimator) const
+    {
+        Result                                   &result = chain.result;
+        Record                                   oldrecord;
+        double                                   oldlogL, newlogL;
+        bool                                     stop_flag;
+        std::array <double, mixture_num>         tmp_pi;
+        std::array <dvector <dim>, mixture_num>  tmp_mus;
+        std::array <dmatrix <dim>, mixture_num>  tmp_sigmas;
+        Sufficient_statistics <dim, mixture_num> stats;
+        for (int step = 0; step < steps; step++) {
+            // 更新
+            oldrecord = result.record;
+            oldlogL   = result.logL;
+            if (!estimator.prepare(oldrecord, true)) {
+                // 分散が正定値でなくなれば，この初期値ではダメ．
+                result.status = CHAIN::FAILED;
+                chain.running = false;
+
+                return;
+            }
+            stats.clear();
+            estimator.accumulate(_X, stats);
+            std::tie(tmp_pi, tmp_mus, tmp_sigmas, newlogL) = stats.record();
+            result.record                                  = std::make_tuple(tmp_pi, tmp_mus, tmp_sigmas);
+            result.logL                                    = newlogL;
+            chain.increment                                = newlogL - oldlogL;
+
+            // 無限ループストッパ
+            if (result.steps > big_num) {
+                result.status = CHAIN::FAILED;
+                chain.running = false;
+
+                return;
+            }
+
+            // ひとつでも大きければ続行．
+            stop_flag = true;
+            for (int dist = 0; dist < mixture_num && stop_flag; dist++) {
+                if (fabs(std::get <0>(result.record)[dist] - std::get <0>(oldrecord)[dist]) > epsilon
+                    || matrix_util::d_inf(std::get <1>(result.record)[dist], std::get <1>(oldrecord)[dist]) > epsilon
+                    || matrix_util::d_inf(std::get <2>(result.record)[dist], std::get <2>(oldrecord)[dist]) > epsilon) {
+                    stop_flag = false;
+                }
+            }
+            if (fabs(newlogL - oldlogL) > epsilon) {
+                stop_flag = false;
+            }
+            if (stop_flag && result.steps > least) {
+                result.status = CHAIN::SUCCESS;
+                chain.running = false;
+
+                return;
+            }
+
+            result.steps++;
+        }
+    }
+
+    template <int dim, int mixture_num>
+    bool Multi_start <dim, mixture_num>::dominated(const Chain &chain, const double best) const
+    {
+        // EMでは対数尤度は単調に増えるが，増分は減っていくので線形外挿は楽観的な見積もりになる．
+        return dominance_horizon > 0 && chain.result.steps >= dominance_least
+               && chain.result.logL + dominance_horizon * chain.increment < best - dominance_margin;
+    }
+
+    template <int dim, int mixture_num>
+    void Multi_start <dim, mixture_num>::output(std::ostream &os, const statistic_util::Header &header, const char delim)
+    {
+        Estimator::output(os, header, delim);
+        os << delim << "logL";
+        os << delim;
+        Estimator::output(os, header, delim);
+        os << delim << "logL";
+        os << delim << "step";
+        os << delim << "status";
+    }
+
+    template <int dim, int mixture_num>
+    void Multi_start <dim, mixture_num>::output(std::ostream &os, const Result &result, const char delim)
+    {
+        Estimator::output(os, result.initial, delim);
+        os << delim;
+        if (!result.initial_logL) {
+            os << "NA";
+            os << delim;
+            Estimator::output(os, statistic_util::NA(), delim);
+            os << delim << "NA";
+            os << delim << "NA";
+            os << delim << "invalid";
+
+            return;
+        }
+        os << *result.initial_logL;
+        os << delim;
+        switch (result.status) {
+            case CHAIN::FAILED:
+                Estimator::output(os, statistic_util::NA(), delim);
+                os << delim << "NA";
+                os << delim << "NA";
+                os << delim << "failed";
+                break;
+            case CHAIN::SUCCESS:
+            case CHAIN::DOMINATED:
+                Estimator::output(os, result.record, delim);
+                os << delim << result.logL;
+                os << delim << result.steps;
+                os << delim << ((result.status == CHAIN::SUCCESS) ? "success" : "dominated");
+                break;
+        }
+    }
+
+    void test_EM_initial_value_parallel(const std::string &numbering, const int threads)
+    {
+        constexpr int dim         = DIM; // 2次元
+        constexpr int mixture_num = MIXTURE_NUM;  // 混合数
+        constexpr int num         = NUM;
+        using DS = statistic::Data_series <dim, num>;
+        constexpr statistic_util::FORMAT format = statistic_util::FORMAT::CSV_COMMA;
+        constexpr char                   delim  = formatToDelim(format);
+        using EM     = EM_estimator <dim, statistic::GAUSSIAN_MIXTURES <mixture_num> >;
+        using Record = EM::Record;
+        using MS     = Multi_start <dim, mixture_num>;
+
+        // データの読込
+        std::ifstream fin("data03/square" + std::to_string(num) + ".dataset");
+        DS            ds(fin, format);
+        fin.close();
+
+        // 初期値データの読込
+        std::vector <Record> initials;
+        fin.open("data03/square_initial" + numbering + ".csv");
+        const int big_num = 1000;
+        while (static_cast <int>(initials.size()) < big_num) {
+            const Record record = EM::input(fin, delim);
+            if (fin.fail()) {
+                break;
+            }
+            initials.push_back(record);
+        }
+        fin.close();
+
+        const auto results = MS(ds).run(initials, threads);
+
+        // 初期値の順に書き出す
+        std::ofstream fout("data03/square" + std::to_string(num) + "_initialtest" + numbering + ".csv");
+        MS::output(fout, statistic_util::Header(), delim);
+        fout << std::endl;
+        int counts[3] = { 0, 0, 0 };
+        for (const auto &result : results) {
+            MS::output(fout, result, delim);
+            fout << std::endl;
+            counts[static_cast <int>(result.status)]++;
+        }
+        fout.close();
+
+        std::cout << "(" << numbering << ")" << "initial : " << results.size()
+                  << ", success : " << counts[static_cast <int>(CHAIN::SUCCESS)]
+                  << ", failed : " << counts[static_cast <int>(CHAIN::FAILED)]
+                  << ", dominated : " << counts[static_cast <int>(CHAIN::DOMINATED)] << std::endl;
+    }
+}
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef DETAIL_EM_ONLINE
+#define DETAIL_EM_ONLINE
+
+#include <cmath>
+#include <fstream>
+#include "../EM_online.hpp"
+
+namespace EM {
+    template <int dim, int mixture_num>
+    double Online_EM_estimator <dim, mixture_num>::alpha = 0.6;
+
+    template <int dim, int mixture_num>
+    Online_EM_estimator <dim, mixture_num>::Online_EM_estimator(const Record &initial, const int batch_size)
+        : _record(initial), _buffer(std::max(batch_size, 1), dim), _steps(0), _logL(0.)
+    {
+    }
+
+    template <int dim, int mixture_num>
+    bool Online_EM_estimator <dim, mixture_num>::step(const Data_ref &batch)
+    {
+        if (batch.rows() == 0 || !_estimator.prepare(_record, true)) {
+            return false;
+        }
+        _batch.clear();
+        _estimator.accumulate(batch, _batch);
+
+        // 最初のステップはeta = 1なのでミニバッチの統計量そのもの
+        const double eta = pow(_steps + 1., -alpha);
+        Statistics   stats(_stats);
+        stats.interpolate(_batch, eta);
+
+        std::array <double, mixture_num>        tmp_pi;
+        std::array <dvector <dim>, mixture_num> tmp_mus;
+        std::array <dmatrix <dim>, mixture_num> tmp_sigmas;
+        double                                  tmp_logL;
+        std::tie(tmp_pi, tmp_mus, tmp_sigmas, tmp_logL) = stats.record();
+        _record                                         = std::make_tuple(tmp_pi, tmp_mus, tmp_sigmas);
+        _stats                                          = stats;
+        _logL                                           = _batch.logL / _batch.num;
+        _steps++;
+
+        return true;
+    }
+
+    template <int dim, int mixture_num>
+    template <class Generator>
+    bool Online_EM_estimator <dim, mixture_num>::sample_step(Generator &&generate)
+    {
+        for (int t = 0; t < _buffer.rows(); t++) {
+            const dvector <dim> x = generate();
+            for (int i = 0; i < dim; i++) {
+                _buffer(t, i) = x(i);
+            }
+        }
+
+        return step(_buffer);
+    }
+
+    template <int dim, int mixture_num>
+    bool Online_EM_estimator <dim, mixture_num>::fit(Chunk_reader <dim> &reader, const int passes)
+    {
+        for (int pass = 0; pass < passes; pass++) {
+            reader.rewind();
+            while (reader.next()) {
+                if (!step(reader.chunk())) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    template <int dim, int mixture_num>
+    const typename Online_EM_estimator <dim, mixture_num>::Record&Online_EM_estimator <dim, mixture_num>::record() const
+    {
+        return _record;
+    }
+
+    template <int dim, int mixture_num>
+    int Online_EM_estimator <dim, mixture_num>::steps() const
+    {
+        return _steps;
+    }
+
+    template <int dim, int mixture_num>
+    double Online_EM_estimator <dim, mixture_num>::logL() const
+    {
+        return _logL;
+    }
+
+    // 真の分布からのデータ，データファイルの2通りでオンラインEMを回し，
+    // データファイル全体でのバッチEMと対数尤度を比べる．
+    void test_EM_online()
+    {
+        constexpr int dim         = DIM;
+        constexpr int mixture_num = MIXTURE_NUM;
+        using PD = statistic::Probability_distribution <dim, statistic::GAUSSIAN_MIXTURES <mixture_num> >;
+        using DS = statistic::Data_series <dim, statistic::DYNAMIC>;
+        constexpr statistic_util::FORMAT format = statistic_util::FORMAT::CSV_COMMA;
+        constexpr char                   delim  = formatToDelim(format);
+        using EM      = EM_estimator <dim, statistic::GAUSSIAN_MIXTURES <mixture_num> >;
+        using Blocked = Blocked_EM_estimator <dim, mixture_num>;
+        using Online  = Online_EM_estimator <dim, mixture_num>;
+        using Record  = EM::Record;
+        constexpr int batch_size = 100;
+        constexpr int steps      = 1000;
+        constexpr int passes     = 5;
+
+        // 真の分布（data03/square.trueparam）
+        std::array <double, mixture_num>        pi = { 0.1, 0.2, 0.3, 0.4 };
+        std::array <dvector <dim>, mixture_num> mus;
+        mus[0](0) = -2.; mus[0](1) = -2.;
+        mus[1](0) = -2.; mus[1](1) = 2.;
+        mus[2](0) = 2.; mus[2](1) = -2.;
+        mus[3](0) = 2.; mus[3](1) = 2.;
+        std::array <dmatrix <dim>, mixture_num> As;
+        for (auto &A : As) {
+            A(0, 0) = 1.; A(0, 1) = 0.;
+            A(1, 0) = 0.; A(1, 1) = 1.;
+        }
+        PD pd(pi, mus, As);
+
+        // 初期値
+        std::array <double, mixture_num>        pi0 = { 0.25, 0.25, 0.25, 0.25 };
+        std::array <dvector <dim>, mixture_num> mus0;
+        std::array <dmatrix <dim>, mixture_num> sigmas0;
+        for (int dist = 0; dist < mixture_num; dist++) {
+            mus0[dist] = 0.5 * mus[dist];
+            sigmas0[dist](0, 0) = 2.; sigmas0[dist](0, 1) = 0.;
+            sigmas0[dist](1, 0) = 0.; sigmas0[dist](1, 1) = 2.;
+        }
+        const Record initial = std::make_tuple(pi0, mus0, sigmas0);
+
+        const std::string filename = "data03/square1000.dataset";
+        std::ifstream     fin(filename);
+        DS                ds(fin, format);
+        fin.close();
+        Blocked blocked(ds);
+
+        // 生成器から
+        Online online(initial, batch_size);
+        for (int step = 0; step < steps; step++) {
+            if (!online.sample_step([&pd]() {
+                                 return pd.generate();
+                             })) {
+                std::cout << "failed at step " << step << "." << std::endl;
+                break;
+            }
+        }
+        std::cout << "online (generator) : " << online.steps() << " steps, " << online.steps() * batch_size << " samples, logL = " << *blocked.logL(online.record()) << std::endl;
+        EM::output(std::cout, online.record(), delim);
+        std::cout << std::endl;
+
+        // データファイルから
+        std::ifstream      datain(filename);
+        Chunk_reader <dim> reader(datain, format, batch_size);
+        Online             online_file(initial, batch_size);
+        if (!online_file.fit(reader, passes)) {
+            std::cout << "failed." << std::endl;
+        }
+        std::cout << "online (file) : " << passes << " passes, logL = " << *blocked.logL(online_file.record()) << std::endl;
+        EM::output(std::cout, online_file.record(), delim);
+        std::cout << std::endl;
+
+        // バッチEM
+        Record                                  record = initial;
+        double                                  logL   = 0.;
+        int                                     step;
+        std::array <double, mixture_num>        tmp_pi;
+        std::array <dvector <dim>, mixture_num> tmp_mus;
+        std::array <dmatrix <dim>, mixture_num> tmp_sigmas;
+        for (step = 0; step < steps; step++) {
+            const auto up = blocked.update(record);
+            if (!up) {
+                break;
+            }
+            const double oldlogL = logL;
+            std::tie(tmp_pi, tmp_mus, tmp_sigmas, logL) = *up;
+            record                                      = std::make_tuple(tmp_pi, tmp_mus, tmp_sigmas);
+            if (step > 0 && fabs(logL - oldlogL) < statistic_util::epsilon) {
+                break;
+            }
+        }
+        std::cout << "batch : " << step << " passes, logL = " << *blocked.logL(record) << std::endl;
+        EM::output(std::cout, record, delim);
+        std::cout << std::endl;
+    }
+}
+
+#endif
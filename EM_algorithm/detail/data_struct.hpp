@@ -45,6 +45,72 @@ namespace statistic {
         return _x;
     }
 
+    template <int dim, int num>
+    int Data_series <dim, num>::size() const
+    {
+        return num;
+    }
+
+    template <int dim>
+    bool read_datum(std::istream &datain, const statistic_util::FORMAT &format, dvector <dim> &x)
+    {
+        char delim;
+        std::string line;
+        for (int i = 0; i < dim; i++) {
+            if (!(datain >> x(i))) {
+                return false;
+            }
+            if (format == statistic_util::FORMAT::CSV_COMMA && i != dim - 1) {
+                datain >> delim;
+            }
+        }
+        getline(datain, line);
+
+        return true;
+    }
+
+    template <int dim>
+    Data_series <dim, DYNAMIC>::Data_series(std::istream &datain, const statistic_util::FORMAT &format)
+    {
+        dvector <dim> x;
+        while (read_datum <dim>(datain, format, x)) {
+            _x.push_back(x);
+        }
+    }
+
+    template <int dim>
+    template <class distribution>
+    Data_series <dim, DYNAMIC>::Data_series(PD <dim, distribution> &pd, const int num)
+    {
+        _x.reserve(num);
+        for (int t = 0; t < num; t++) {
+            _x.push_back(pd.generate());
+        }
+    }
+
+    template <int dim>
+    void Data_series <dim, DYNAMIC>::output(std::ostream &os, const statistic_util::FORMAT &format) const
+    {
+        const char delim = statistic_util::formatToDelim(format);
+        for (const auto &x : _x) {
+            for (int i = 0; i < dim; i++) {
+                os << x(i) << ((i != dim - 1) ? delim : '\n');
+            }
+        }
+    }
+
+    template <int dim>
+    const std::vector<dvector<dim>>& Data_series <dim, DYNAMIC>::dataset() const
+    {
+        return _x;
+    }
+
+    template <int dim>
+    int Data_series <dim, DYNAMIC>::size() const
+    {
+        return _x.size();
+    }
+
     void test_data_series_gaussian()
     {
         constexpr int dim = 2;  // 2次元
@@ -25,7 +25,7 @@ namespace statistic {
     template <int dim>
     double Probability_distribution <dim, GAUSSIAN>::pdf(const dvector <dim> &x) const
     {
-        return pnorm(x, _mu, _sigmaInverse, _sigmaDeterminant);
+        return statistic_util::pnorm <dim>(x, _mu, _sigmaInverse, _sigmaDeterminant);
     }
 
     // データ生成関数
@@ -246,6 +246,9 @@ namespace statistic {
         _sigmas = util::Apply <dmatrix <dim>, 1>::apply(As, local_transToSigma);
         _sigmaInverses = util::Apply <dmatrix <dim>, 1>::apply(_sigmas, local_invert);
         _sigmaDeterminants = util::Apply <dmatrix <dim>, 1>::apply(_sigmas, local_determinant);
+        for (int dist = 0; dist < mixture_num; dist++) {
+            _logcoefs[dist] = log(pi[dist]) + statistic_util::log_normalize <dim>() - 0.5 * log(_sigmaDeterminants[dist]);
+        }
 
         double sum = 0.;
         for (auto p : pi) {
@@ -261,12 +264,138 @@ namespace statistic {
     {
         double sum = 0.;
         for (int i = 0; i < mixture_num; i++) {
-            sum += _pi[i] * pnorm(x, _mus[i], _sigmaInverses[i], _sigmaDeterminants[i]);
+            sum += _pi[i] * statistic_util::pnorm <dim>(x, _mus[i], _sigmaInverses[i], _sigmaDeterminants[i]);
         }
 
         return sum;
     }
 
+    template <int dim, int mixture_num>
+    template <bool log_scale>
+    void Probability_distribution <dim, GAUSSIAN_MIXTURES <mixture_num> >::evaluate(const double *x, const int n, const int first, const int last, double *out) const
+    {
+        // 分布ごと，成分ごとに点の方向へ連続な配列で回すので，内側のループはベクトル化される．
+        std::array <std::array <double, batch_size>, dim>         d;
+        std::array <std::array <double, batch_size>, mixture_num> logp;
+        for (int begin = first; begin < last; begin += batch_size) {
+            const int size = std::min(batch_size, last - begin);
+            for (int dist = 0; dist < mixture_num; dist++) {
+                const dmatrix <dim> &Q = _sigmaInverses[dist];
+                for (int i = 0; i < dim; i++) {
+                    const double *xi = x + static_cast <std::ptrdiff_t>(i) * n + begin;
+                    const double  mu = _mus[dist](i);
+                    for (int t = 0; t < size; t++) {
+                        d[i][t] = xi[t] - mu;
+                    }
+                }
+                // マハラノビス距離 (x - mu)^T Q (x - mu)．Qの対称性で下三角だけ使う．
+                double *lp = logp[dist].data();
+                for (int t = 0; t < size; t++) {
+                    lp[t] = 0.;
+                }
+                for (int i = 0; i < dim; i++) {
+                    for (int j = 0; j < i; j++) {
+                        const double q = 2. * Q(i, j);
+                        for (int t = 0; t < size; t++) {
+                            lp[t] += q * d[i][t] * d[j][t];
+                        }
+                    }
+                    const double q = Q(i, i);
+                    for (int t = 0; t < size; t++) {
+                        lp[t] += q * d[i][t] * d[i][t];
+                    }
+                }
+                const double c = _logcoefs[dist];
+                for (int t = 0; t < size; t++) {
+                    lp[t] = c - 0.5 * lp[t];
+                }
+            }
+
+            double *o = out + begin;
+            if (log_scale) {
+                // log-sum-exp
+                for (int t = 0; t < size; t++) {
+                    double max = logp[0][t];
+                    for (int dist = 1; dist < mixture_num; dist++) {
+                        max = std::max(max, logp[dist][t]);
+                    }
+                    double sum = 0.;
+                    for (int dist = 0; dist < mixture_num; dist++) {
+                        sum += exp(logp[dist][t] - max);
+                    }
+                    o[t] = max + log(sum);
+                }
+            } else {
+                for (int t = 0; t < size; t++) {
+                    o[t] = 0.;
+                }
+                for (int dist = 0; dist < mixture_num; dist++) {
+                    for (int t = 0; t < size; t++) {
+                        o[t] += exp(logp[dist][t]);
+                    }
+                }
+            }
+        }
+    }
+
+    template <int dim, int mixture_num>
+    template <bool log_scale>
+    void Probability_distribution <dim, GAUSSIAN_MIXTURES <mixture_num> >::evaluate(const double *x, const int n, double *out, const int threads) const
+    {
+        if (threads > 1 && n >= parallel_threshold) {
+            parallel::Thread_pool pool(threads - 1);
+            pool.parallel_for(0, n, [&](const std::ptrdiff_t first, const std::ptrdiff_t last) {
+                                  evaluate <log_scale>(x, n, first, last, out);
+                              }, batch_size);
+        } else {
+            evaluate <log_scale>(x, n, 0, n, out);
+        }
+    }
+
+    template <int dim, int mixture_num>
+    void Probability_distribution <dim, GAUSSIAN_MIXTURES <mixture_num> >::pdf(const double *x, const int n, double *out, const int threads) const
+    {
+        evaluate <false>(x, n, out, threads);
+    }
+
+    template <int dim, int mixture_num>
+    void Probability_distribution <dim, GAUSSIAN_MIXTURES <mixture_num> >::log_pdf(const double *x, const int n, double *out, const int threads) const
+    {
+        evaluate <true>(x, n, out, threads);
+    }
+
+    // データ生成関数
+    template <int dim, int mixture_num>
+    void Probability_distribution <dim, GAUSSIAN_MIXTURES <mixture_num> >::generate(const int n, double *out)
+    {
+        std::array <double, dim> z;
+        for (int t = 0; t < n; t++) {
+            // まずどの分布から選択されるかを選択．
+            const double uni       = _mixvoter(_mt);
+            double       cummurate = 0.;
+            int          mixindex  = 0;
+            for (int dist = 0; dist < mixture_num; dist++) {
+                cummurate += _pi[dist];
+                if (uni < cummurate) {
+                    mixindex = dist;
+                    break;
+                }
+            }
+            // 多変量標準正規分布を生成
+            for (int i = 0; i < dim; i++) {
+                z[i] = _stdnorm(_mt);
+            }
+            const dmatrix <dim> &A = _As[mixindex];
+            for (int i = 0; i < dim; i++) {
+                double xi = _mus[mixindex](i);
+                for (int j = 0; j < dim; j++) {
+                    xi += A(i, j) * z[j];
+                }
+                out[static_cast <std::ptrdiff_t>(i) * n + t] = xi;
+            }
+        }
+    }
+
     // データ生成関数
     template <int dim, int mixture_num>
     dvector <dim> Probability_distribution <dim, GAUSSIAN_MIXTURES <mixture_num> >::generate()
@@ -314,26 +443,23 @@ namespace statistic {
         }
 
         os << std::endl;
-        using namespace std::placeholders;
-        const auto nonmemberpdf = [&](const dvector <dim> &x) {
-                                      using namespace boost::numeric;
-                                      double sum = 0.;
-                                      double exponent;
-                                      for (int i = 0; i < mixture_num; i++) {
-                                          exponent = -0.5 * ublas::inner_prod((x - _mus[i]), ublas::prod(_sigmaInverses[i], (x - _mus[i])));
-
-                                          sum += _pi[i] * statistic_util::normalize <dim>() / sqrt(_sigmaDeterminants[i]) * exp(exponent);
-                                      }
-
-                                      return sum;
-                                  };
-        statistic_util::expand_array <1, double, Meshes ...> M = statistic_util::Descretize <Meshes ...>::descretizeDV(nonmemberpdf, range);
+        // 格子の1行（最後の軸に沿った点列）をSoA形式に並べてまとめて評価する．
+        const auto rowpdf = [&](const dvector <dim> &x0, const double mesh, const int n, double *out) {
+                                std::vector <double> x(static_cast <std::size_t>(dim) * n);
+                                for (int i = 0; i < dim - 1; i++) {
+                                    std::fill(x.begin() + i * n, x.begin() + (i + 1) * n, x0(i));
+                                }
+                                for (int t = 0; t < n; t++) {
+                                    x[(dim - 1) * n + t] = x0(dim - 1) + t * mesh;
+                                }
+                                pdf(x.data(), n, out);
+                            };
+        const statistic_util::Flat_grid <dim> grid = statistic_util::Flat_descretize <Meshes ...>::descretize_rows(rowpdf, range);
         os << "# --- pdf ----" << std::endl;
 
-        auto out = [&](double d) {
-                       os << d << std::endl;
-                   };
-        util::Apply <double, dim, void>::apply(M, out);
+        for (const double d : grid.values) {
+            os << d << std::endl;
+        }
     }
 
     // 疎結合性を考えればこれはいらない．
@@ -441,6 +567,67 @@ namespace statistic {
         pd.output <20, 20>(fout, range, format);
         fout.close();
     }
+
+    // バッチ版pdf/log_pdfを1点ずつのpdfと比べ，バッチ生成の標本平均を真の平均と比べる．
+    void testgaussian_mixtures_batch()
+    {
+        constexpr int dim         = 2;
+        constexpr int mixture_num = 3;
+        using PD = Probability_distribution <dim, GAUSSIAN_MIXTURES <mixture_num> >;
+        constexpr int n       = 100000;
+        constexpr int threads = 4;
+
+        std::array <double, mixture_num> pi = { 0.2, 0.3, 0.5 };
+
+        std::array <dvector <dim>, mixture_num> mus;
+        mus[0](0) = -3.; mus[0](1) = 0.;
+        mus[1](0) = 0.; mus[1](1) = 3.;
+        mus[2](0) = 3.; mus[2](1) = -1.;
+
+        std::array <dmatrix <dim>, mixture_num> As;
+        As[0](0,0) = 1.; As[0](0,1) = 0.;
+        As[0](1,0) = 0.5; As[0](1,1) = 1.;
+        As[1](0,0) = 2.; As[1](0,1) = 0.;
+        As[1](1,0) = 0.; As[1](1,1) = 0.5;
+        As[2](0,0) = 1.; As[2](0,1) = -0.3;
+        As[2](1,0) = 0.3; As[2](1,1) = 1.;
+
+        PD pd(pi, mus, As);
+
+        // バッチ生成
+        std::vector <double> x(dim * n);
+        pd.generate(n, x.data());
+        dvector <dim> mean = boost::numeric::ublas::zero_vector <double>(dim), truemean = boost::numeric::ublas::zero_vector <double>(dim);
+        for (int dist = 0; dist < mixture_num; dist++) {
+            truemean += pi[dist] * mus[dist];
+        }
+        for (int i = 0; i < dim; i++) {
+            for (int t = 0; t < n; t++) {
+                mean(i) += x[i * n + t];
+            }
+            mean(i) /= n;
+        }
+        std::cout << "sample mean : ";
+        statistic_util::output <dim>(std::cout, mean, ',');
+        std::cout << "true mean : ";
+        statistic_util::output <dim>(std::cout, truemean, ',');
+
+        // バッチ評価
+        std::vector <double> p(n), logp(n), p1(n);
+        pd.pdf(x.data(), n, p.data(), 1);
+        pd.log_pdf(x.data(), n, logp.data(), threads);
+        dvector <dim> xt;
+        double        maxdiff = 0., maxlogdiff = 0.;
+        for (int t = 0; t < n; t++) {
+            for (int i = 0; i < dim; i++) {
+                xt(i) = x[i * n + t];
+            }
+            p1[t]      = pd.pdf(xt);
+            maxdiff    = std::max(maxdiff, fabs(p[t] - p1[t]) / p1[t]);
+            maxlogdiff = std::max(maxlogdiff, fabs(logp[t] - log(p1[t])));
+        }
+        std::cout << "max relative diff (pdf) : " << maxdiff << ", max diff (log_pdf) : " << maxlogdiff << std::endl;
+    }
 }
 
 #endif
@@ -137,6 +137,84 @@ namespace statistic_util {
         return pow(1 / (sqrt(2. * M_PI)), dim);
     }
 
+    template <int dim>
+    boost::optional <dmatrix <dim> > cholesky(const dmatrix <dim> &m)
+    {
+        dmatrix <dim> L(dim, dim);
+        L.clear();
+        for (int j = 0; j < dim; j++) {
+            double d = m(j, j);
+            for (int k = 0; k < j; k++) {
+                d -= L(j, k) * L(j, k);
+            }
+            // 正定値でない．NaNもここで弾く．
+            if (!(d > 0.)) {
+                return boost::none;
+            }
+            L(j, j) = sqrt(d);
+            for (int i = j + 1; i < dim; i++) {
+                double s = m(i, j);
+                for (int k = 0; k < j; k++) {
+                    s -= L(i, k) * L(j, k);
+                }
+                L(i, j) = s / L(j, j);
+            }
+        }
+
+        return L;
+    }
+
+    template <int dim>
+    double log_determinant(const dmatrix <dim> &L)
+    {
+        double logdet = 0.;
+        for (int i = 0; i < dim; i++) {
+            logdet += log(L(i, i));
+        }
+
+        return 2. * logdet;
+    }
+
+    template <int dim>
+    double log_pnorm(const dvector <dim> &x, const dvector <dim> &mu, const dmatrix <dim> &L, double logDeterminant)
+    {
+        // 前進代入で z = L^-1 (x - mu) を求めると，マハラノビス距離は |z|^2
+        std::array <double, dim> z;
+        double                   mahalanobis = 0.;
+        for (int i = 0; i < dim; i++) {
+            double s = x(i) - mu(i);
+            for (int k = 0; k < i; k++) {
+                s -= L(i, k) * z[k];
+            }
+            z[i]         = s / L(i, i);
+            mahalanobis += z[i] * z[i];
+        }
+
+        return log_normalize <dim>() - 0.5 * logDeterminant - 0.5 * mahalanobis;
+    }
+
+    template <int dim>
+    double log_normalize()
+    {
+        return -0.5 * dim * log(2. * M_PI);
+    }
+
+    template <std::size_t n>
+    double logsumexp(const std::array <double, n> &a)
+    {
+        const double max = *std::max_element(a.begin(), a.end());
+        // すべて-infのとき
+        if (std::isinf(max)) {
+            return max;
+        }
+        double sum = 0.;
+        for (const double ai : a) {
+            sum += exp(ai - max);
+        }
+
+        return max + log(sum);
+    }
+
     template <int num, int mixture_num>
     double logL(const std::array <double, mixture_num> &pi, const std::array <std::array <double, mixture_num>, num> &p)
     {
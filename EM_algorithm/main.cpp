@@ -1,6 +1,7 @@
 ﻿char *gets(char *str);
 
 #include "EM_algorithm.hpp"
+#include "EM_multistart.hpp"
 // #include "data_struct.hpp"
 // #include "pdist.hpp"
 // #include "statistic_utiltest.hpp"
@@ -11,7 +12,8 @@ int main(int argc, char const *argv[])
     // const auto numberings = util::make_array<std::string>("01", "02", "03", "04", "05", "06");
     const auto numberings = util::make_array<std::string>("01");
     for (auto numbering : numberings) {
-        EM::test_EM_initial_value(numbering);
+        // EM::test_EM_initial_value(numbering);
+        EM::test_EM_initial_value_parallel(numbering);
     }
     // statistic::Probability_distribution <2, statistic::GAUSSIAN_MIXTURES <2> >::test();
     // statistic_util::testdescreteDV1();
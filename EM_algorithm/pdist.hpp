@@ -6,6 +6,9 @@
 #include <array>
 #include <random>
 #include <functional>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
 #include "statistic_util.hpp"
 #include "../lab/util.hpp"
 
@@ -83,13 +86,32 @@ namespace statistic {
 
         double        pdf(const dvector <dim> &x) const; // 確率密度関数
 
+        // n点をまとめて評価するpdf，対数pdf
+        // xはn×dimの列優先（SoA）配列で，x[i * n + t]が第t点の第i成分．結果をout[t]に書く．
+        // n >= parallel_threshold のときthreads個のスレッドで分担する．
+        void          pdf(const double *x, const int n, double *out, const int threads=1) const;
+        void          log_pdf(const double *x, const int n, double *out, const int threads=1) const;
+
         dvector <dim> generate(); // 確率分布からデータを1つ生成する関数
 
+        // n個生成し，n×dimの列優先配列outに書く．乱数の消費順はgenerate()をn回呼ぶのと同じ．
+        void          generate(const int n, double *out);
+
         template <int ... Meshes>
         void output(std::ostream &os, const statistic_util::Range <dim> &range, const statistic_util::FORMAT format) const;        // ファイルに書き出す
         void outparam(std::ostream &os, const statistic_util::FORMAT format) const;        // パラメータをファイルに書き出す
 
+        static constexpr int batch_size         = 256;   // まとめて評価する点数
+        static constexpr int parallel_threshold = 4096;  // これより少ない点数は逐次に評価する
+
     private:
+        // [first, last)の点の各分布の重み付き対数密度をlogpに求め，log-sum-expまたは和をoutに書く
+        template <bool log_scale>
+        void          evaluate(const double *x, const int n, const int first, const int last, double *out) const;
+
+        template <bool log_scale>
+        void          evaluate(const double *x, const int n, double *out, const int threads) const;
+
         const std::array <double, mixture_num>        _pi; // 混合比
         const std::array <dvector <dim>, mixture_num> _mus;  // 平均ベクトル
         const std::array <dmatrix <dim>, mixture_num> _As;  // 変換行列
@@ -97,6 +119,7 @@ namespace statistic {
         // 以下冗長
         std::array <dmatrix <dim>, mixture_num> _sigmaInverses;  // 精度行列
         std::array <double, mixture_num>        _sigmaDeterminants; // 分散共分散行列のディターミナント
+        std::array <double, mixture_num>        _logcoefs; // log(pi) + log(正規化子) - log|sigma| / 2
         // 乱数生成器
         std::random_device                     _rnd; // 非決定的乱数生成器
         std::mt19937                     _mt; // メルセンヌ・ツイスタ
@@ -106,6 +129,7 @@ namespace statistic {
 
     void testgaussian();
     // void testgaussian_mixtures();
+    void testgaussian_mixtures_batch();
 }
 
 #include "detail/pdist.hpp"
@@ -3,7 +3,10 @@
 
 #include <iostream>
 #include <vector>
+#include <array>
+#include <cmath>
 #include "../lab/util.hpp"
+#include "../lab/thread_pool.hpp"
 #include "matrix_util.hpp"
 
 namespace statistic_util {
@@ -98,6 +101,27 @@ namespace statistic_util {
     template <int dim>
     constexpr double normalize();
 
+    // Cholesky分解 m = L * L^T．下三角のLを返す．正定値でないとき，失敗．
+    template <int dim>
+    boost::optional <dmatrix <dim> > cholesky(const dmatrix <dim> &m);
+
+    // Cholesky因子から分散共分散行列の対数行列式を得る
+    template <int dim>
+    double log_determinant(const dmatrix <dim> &L);
+
+    // 多次元正規分布の対数pdf
+    // 分散共分散行列のCholesky因子Lとその対数行列式を与える
+    template <int dim>
+    double log_pnorm(const dvector <dim> &x, const dvector <dim> &mu, const dmatrix <dim> &L, double logDeterminant);
+
+    // （内部的に使用）多次元正規分布の正規化子の対数
+    template <int dim>
+    double log_normalize();
+
+    // log(sum_i exp(a_i))．最大値を括り出してアンダーフローを防ぐ．
+    template <std::size_t n>
+    double logsumexp(const std::array <double, n> &a);
+
     // 混合正規分布の対数尤度
     // 混合率とデータごと，分布ごとの確率pを与える
     template <int num, int mixture_num>
@@ -441,6 +465,132 @@ namespace statistic_util {
             return std::move(fd);
         }
     };
+
+    // ・Flat_grid
+    // 格子上の関数値を行優先（最後の軸が最も内側）で平坦に並べたもの．
+    // shape[i]は第i軸の点数で，メッシュ数より1だけ多い．
+    template <int dim>
+    struct Flat_grid
+    {
+        Range <dim>              range;
+        std::array <int, dim>    shape;
+        std::vector <double>     values;
+
+        Flat_grid(const Range <dim> &range_, const std::array <int, dim> &shape_)
+            : range(range_), shape(shape_)
+        {
+            std::size_t size = 1;
+            for (const int n : shape) {
+                size *= n;
+            }
+            values.resize(size);
+        }
+
+        // 第axis軸のindex番目の座標
+        double coordinate(const int axis, const int index) const
+        {
+            return range.x1()[axis] + index * mesh(axis);
+        }
+
+        double mesh(const int axis) const
+        {
+            return (range.x2()[axis] - range.x1()[axis]) / (shape[axis] - 1);
+        }
+
+        // 最後の軸に沿った1行の点数と行数
+        int row_size() const
+        {
+            return shape[dim - 1];
+        }
+
+        int rows() const
+        {
+            return values.size() / row_size();
+        }
+    };
+
+    // ・Flat_descretize
+    // Descretizeと同じ格子上で関数を並列に評価し，Flat_gridに書き出す．
+    //     Flat_descretize<100, 100>::descretizeDV(f, range, &pool)
+    //     Flat_descretize<100, 100>::descretize_rows(g, range, &pool)
+    // のような呼び出しを期待する．
+    // descretizeDVのfはDescretize::descretizeDVと同じくf(dvector<dim>)．
+    // descretize_rowsのgは最後の軸に沿った1行をまとめて評価するバッチ関数で，
+    //     g(const dvector<dim> &x0, double mesh, int n, double *out)
+    // が x0, x0 + mesh e_last, ..., x0 + (n - 1) mesh e_last での値をoutに書く．
+    // poolを渡すと行の範囲をparallel_forでワーカー数+1個以下の連続した塊に分けて配る．
+    // 1つの塊は少なくともgrain_rows行で，格子が小さければ塊の数が減る．poolがnullptrなら逐次に評価する．
+    // 座標は x1 + i * mesh で求めるので，meshを足し込んでいくDescretizeとは丸め誤差の範囲で異なる．
+    template <int ... Sizes>
+    struct Flat_descretize
+    {
+        static constexpr int dim = sizeof ... (Sizes);
+
+        // 1つの塊が受け持つ最小の行数
+        static constexpr int grain_rows = 16;
+
+        template <typename RowFunctor>
+        static Flat_grid <dim> descretize_rows(const RowFunctor &g, const Range <dim> &range, parallel::Thread_pool *pool=nullptr)
+        {
+            Flat_grid <dim> grid(range, { { (Sizes + 1) ... } });
+            const int       n    = grid.row_size();
+            const double    mesh = grid.mesh(dim - 1);
+
+            const auto rows = [&](const std::ptrdiff_t first, const std::ptrdiff_t last) {
+                                  dvector <dim> x0;
+                                  x0(dim - 1) = range.x1()[dim - 1];
+                                  for (std::ptrdiff_t row = first; row < last; row++) {
+                                      // 行番号を最後以外の軸の添字に戻す
+                                      std::ptrdiff_t rest = row;
+                                      for (int axis = dim - 2; axis >= 0; axis--) {
+                                          x0(axis) = grid.coordinate(axis, rest % grid.shape[axis]);
+                                          rest    /= grid.shape[axis];
+                                      }
+                                      g(x0, mesh, n, grid.values.data() + row * n);
+                                  }
+                              };
+
+            parallel::for_range(pool, 0, grid.rows(), rows, grain_rows);
+
+            return grid;
+        }
+
+        template <typename Functor>
+        static Flat_grid <dim> descretizeDV(const Functor &f, const Range <dim> &range, parallel::Thread_pool *pool=nullptr)
+        {
+            const auto g = [&f](const dvector <dim> &x0, const double mesh, const int n, double *out) {
+                               dvector <dim> x(x0);
+                               for (int j = 0; j < n; j++) {
+                                   x(dim - 1) = x0(dim - 1) + j * mesh;
+                                   out[j]     = f(x);
+                               }
+                           };
+
+            return descretize_rows(g, range, pool);
+        }
+    };
+
+    // ・outputSQ関数（Flat_grid版）
+    // 2次元の格子を目盛り付きの矩形に整形し，バッファから1行ずつ書き出す．
+    inline void outputSQ(std::ostream &os, const Flat_grid <2> &grid, const char delim)
+    {
+        // y軸目盛り
+        for (int j = 0; j < grid.shape[1]; j++) {
+            os << delim << grid.coordinate(1, j);
+        }
+        os << '\n';
+
+        // x軸目盛りおよび本体
+        const double *row = grid.values.data();
+        for (int i = 0; i < grid.shape[0]; i++, row += grid.shape[1]) {
+            os << grid.coordinate(0, i);
+            for (int j = 0; j < grid.shape[1]; j++) {
+                os << delim << row[j];
+            }
+            os << '\n';
+        }
+        os << std::flush;
+    }
 }
 
 #include "detail/statistic_util.hpp"
@@ -74,6 +74,28 @@ namespace statistic_util {
             }
         }
     }
+
+    void testdescreteFlat2()
+    {
+        constexpr int     dim = 2;
+        const auto f = [](const dvector<dim> &v) -> double {
+                           return v(0) * v(0) + v(1) * v(1);
+                       };
+        const Range <dim> range({ -10., -10. }, { 10., 10. });
+        constexpr int     xmeshnum = 200;
+        constexpr int     ymeshnum = 200;
+        auto              fd       = Descretize <xmeshnum, ymeshnum>::descretizeDV(f, range);
+        parallel::Thread_pool pool(3);
+        auto              grid     = Flat_descretize <xmeshnum, ymeshnum>::descretizeDV(f, range, &pool);
+        double            diff     = 0.;
+        for (int i = 0; i <= xmeshnum; i++) {
+            for (int j = 0; j <= ymeshnum; j++) {
+                diff = std::max(diff, fabs(fd[i][j] - grid.values[i * grid.row_size() + j]));
+            }
+        }
+        std::cout << "max diff : " << diff << std::endl;
+        outputSQ(std::cout, grid, ',');
+    }
 }
 
 #endif
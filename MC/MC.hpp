@@ -4,6 +4,7 @@
 #include <unsupported/Eigen/KroneckerProduct>
 #include <debug>
 #include <constexpr/cmath>
+#include "lowrank_prox.hpp"
 
 using Scalar = double;
 
@@ -68,10 +69,12 @@ public:
     Scalar rho;
     Eigen::ConjugateGradient<bigM_type> cg;
     bigM_type coef;
+    Lowrank_prox<Scalar> lowrank_prox;
 public:
     constexpr static int max_rep = 100;
     constexpr static Scalar abs_tol = 1.e-6;
     constexpr static Scalar rel_tol = 1.e-6;
+    constexpr static int prox_rank = 0; // 0のとき完全SVD，正のとき低ランク近接写像の初期探索次元
 public:
     MC()
     {
@@ -85,11 +88,17 @@ public:
         coef += gamma_r*Eigen::kroneckerProduct(Lr, cM_type::Identity()).eval()+gamma_c*Eigen::kroneckerProduct(rM_type::Identity(), Lc)+rho*bigM_type::Identity();
         _PRINT(coef)
         cg.compute(coef);
+        lowrank_prox.reset(prox_rank);
     }
     void X_opt()
     {
         // Y-Zにgamma_n/rhoで近接させる
-        X = prox_nu((Y-Z).eval(), gamma_n/rho);
+        if (prox_rank > 0) {
+            Scalar nu;
+            X = lowrank_prox(Eigen::MatrixXd(Y-Z), gamma_n/rho, nu);
+        } else {
+            X = prox_nu((Y-Z).eval(), gamma_n/rho);
+        }
     }
     void Y_opt()
     {
@@ -1,12 +1,23 @@
+#ifndef MC_DYNAMIC_HPP
+#define MC_DYNAMIC_HPP
+
 #include <exeigen>
 #include <eigen_io>
+#include <eigen_bin>
 #include <fstream>
+#include <cstdio>
+#include <vector>
+#include <array>
+#include <memory>
+#include <cassert>
 #include <Eigen/Sparse>
 #include <Eigen/IterativeLinearSolvers>
-#include <unsupported/Eigen/KroneckerProduct>
 #include <debug>
 #include <constexpr/cmath>
 #include <timer>
+#include <thread_pool>
+#include "kronecker_sum.hpp"
+#include "lowrank_prox.hpp"
 
 using Scalar = double;
 constexpr Scalar epsilon = 1.e-6;
@@ -77,6 +88,7 @@ public:
     using bigV_type = Eigen::VectorX<Scalar>;
     using bigM_type = Eigen::MatrixX<Scalar>;
     using bigSM_type = Eigen::SMatrix<Scalar>;
+    using coef_type = Kronecker_sum<Scalar>;
 public:
     const int m;
     const int n;
@@ -94,57 +106,98 @@ public:
     Scalar gamma_r;
     Scalar gamma_c;
     Scalar rho;
-    bigSM_type coef;
-    Eigen::ConjugateGradient<bigSM_type> cg;
+    coef_type coef; // Y更新の係数行列．行列自由
+    Eigen::ConjugateGradient<coef_type, Eigen::Lower|Eigen::Upper, Kronecker_sum_preconditioner<Scalar>> cg;
+
+    Lowrank_prox<Scalar> lowrank_prox;
 
     Scalar nu;
+    std::vector<int> cg_iterations; // 各反復でのCGの反復回数
+    std::shared_ptr<parallel::Thread_pool> pool; // threads > 1のときのみ
+private:
+    const MC *_problem; // M, A, Lr, Lcを持つMC．既定では自分自身
 public:
     static int max_rep;
     static Scalar abs_tol;
     static Scalar rel_tol;
     static std::string logfile;
+    static int prox_rank; // 0のとき完全SVD，正のとき低ランク近接写像の初期探索次元
+    static bool cg_warm_start; // CGをY_oldから解き始める
+    static Precond cg_precond; // CGの前処理
+    static int threads; // 1のとき逐次実行
+    static bool binary_log; // LOGGERの出力をバイナリ形式にする
+    static std::string checkpoint_file; // 空のときチェックポイントを使わない．実行(ログディレクトリ)ごとに別のファイルにすること
+    static int checkpoint_interval; // 何反復ごとにチェックポイントを書くか．0のとき書かない
+    static bool verbose; // 反復ごとの表示
 public:
     MC(const int m_, const int n_)
-    : m(m_), n(n_), mn(m_*n_), sqrtmn(std::sqrt(m_*n_)), M(SM_type(m_, n_)), A(SM_type(m_, n_)), X(M_type(m_, n_)), Y(M_type(m_, n_)), Y_old(M_type(m_, n_)), Z(M_type(m_, n_)), Lr(SM_type(m_, m_)), Lc(SM_type(n_, n_)), coef(bigSM_type(m_*n_, m_*n_))
+    : m(m_), n(n_), mn(m_*n_), sqrtmn(std::sqrt(m_*n_)), M(SM_type(m_, n_)), A(SM_type(m_, n_)), X(M_type(m_, n_)), Y(M_type(m_, n_)), Y_old(M_type(m_, n_)), Z(M_type(m_, n_)), Lr(SM_type(m_, m_)), Lc(SM_type(n_, n_)), _problem(this)
+    {
+    }
+    /*! @brief otherのM, A, Lr, Lcを参照して解く．ハイパーパラメータだけが違う問題をコピーなしに並べるため．
+        otherはこのオブジェクトより長生きさせること
+    */
+    void share(const MC &other)
     {
+        assert(other.m == m && other.n == n);
+        _problem = &other;
     }
     void init()
     {
+        const MC &p = *_problem;
         Y = Y_old = M_type::Zero(m, n);
-        M_type tmp = M_type(M.transpose());
+        M_type tmp = M_type(p.M.transpose());
         Z = Eigen::Map<M_type>(tmp.data(), Z.rows(), Z.cols());
 
-        // Aを行列化ののち対角行列にする
-        coef.setIdentity();
-        coef *= rho;
-        for (int j = 0; j < A.outerSize(); ++j) {
-            for (typename Eigen::SMatrix <Scalar>::InnerIterator it(A, j); it; ++it)
-            {
-                const int i = it.row();
-                coef.coeffRef(m*j+i, m*j+i) += it.value();
+        // 呼び出し元スレッドも働くのでワーカーはthreads-1
+        if (threads > 1) {
+            if (!pool || static_cast<int>(pool->size()) != threads - 1) {
+                pool = std::make_shared<parallel::Thread_pool>(threads - 1);
             }
+        } else {
+            pool.reset();
         }
-        SM_type matidm(m, m);
-        matidm.setIdentity();
-        matidm *= gamma_r;
-        SM_type matidn(n, n);
-        matidn.setIdentity();
-        matidn *= gamma_c;
-        coef += Eigen::kroneckerProduct(Lr, matidn);
-        coef += Eigen::kroneckerProduct(matidm, Lc);
+
+        // diag(vec(A)) + γr(Lr⊗I) + γc(I⊗Lc) + ρIをLr*Y + Y*Lcの形で作用させる
+        coef.attach(p.A, p.Lr, p.Lc, gamma_r, gamma_c, rho, pool.get());
+        cg.preconditioner().kind = cg_precond;
         cg.compute(coef);
+        cg_iterations.clear();
+        lowrank_prox.reset(prox_rank);
     }
     void X_opt()
     {
         // Y-Zにgamma_n/rhoで近接させる
-        X = prox_nu((Y-Z).eval(), gamma_n/rho, nu);
+        M_type tmp(m, n);
+        parallel::for_range(pool.get(), 0, n, [&](const std::ptrdiff_t j0, const std::ptrdiff_t j1) {
+            tmp.middleCols(j0, j1-j0) = Y.middleCols(j0, j1-j0) - Z.middleCols(j0, j1-j0);
+        });
+        if (prox_rank > 0) {
+            X = lowrank_prox(tmp, gamma_n/rho, nu);
+        } else {
+            X = prox_nu(tmp, gamma_n/rho, nu);
+        }
     }
     void Y_opt()
     {
-        Y_old = Y;
-        M_type tmp = rho*(X+Z);
-        tmp += M;
-        bigV_type tmp2 = cg.solve(Eigen::Map<bigV_type>(tmp.data(), m*n));
+        M_type tmp(m, n);
+        parallel::for_range(pool.get(), 0, n, [&](const std::ptrdiff_t j0, const std::ptrdiff_t j1) {
+            Y_old.middleCols(j0, j1-j0) = Y.middleCols(j0, j1-j0);
+            tmp.middleCols(j0, j1-j0) = rho*(X.middleCols(j0, j1-j0) + Z.middleCols(j0, j1-j0));
+            for (std::ptrdiff_t j = j0; j < j1; ++j) {
+                for (typename SM_type::InnerIterator it(_problem->M, j); it; ++it)
+                {
+                    tmp(it.row(), j) += it.value();
+                }
+            }
+        });
+        bigV_type tmp2;
+        if (cg_warm_start) {
+            tmp2 = cg.solveWithGuess(Eigen::Map<bigV_type>(tmp.data(), m*n), Eigen::Map<const bigV_type>(Y_old.data(), m*n));
+        } else {
+            tmp2 = cg.solve(Eigen::Map<bigV_type>(tmp.data(), m*n));
+        }
+        cg_iterations.push_back(cg.iterations());
         Y = Eigen::Map<M_type>(tmp2.data(), m, n);
     }
     void step()
@@ -155,36 +208,212 @@ public:
         timer.restart();
         Y_opt();
         // _PRINT(timer.elapsed())
-        Z += X - Y;
+        // Z += X - Y
+        parallel::for_range(pool.get(), 0, n, [&](const std::ptrdiff_t j0, const std::ptrdiff_t j1) {
+            Z.middleCols(j0, j1-j0) += X.middleCols(j0, j1-j0) - Y.middleCols(j0, j1-j0);
+        });
     }
     bool stop_cond() const
     {
-        Scalar err_P = (X-Y).norm();
-        Scalar err_D = rho*(Y_old-Y).norm();
-        Scalar tor_P = sqrtmn * abs_tol + rel_tol * std::max(X.norm(), Y.norm());
-        Scalar tor_D = sqrtmn * abs_tol + rel_tol * Z.norm();
+        // ||X-Y||^2, ||Y_old-Y||^2, ||X||^2, ||Y||^2, ||Z||^2を1回の走査で求める．
+        // 列ごとの部分和を順に足すので，スレッド数によらず同じ値になる
+        std::vector<std::array<Scalar, 5>> partial(n);
+        parallel::for_range(pool.get(), 0, n, [&](const std::ptrdiff_t j0, const std::ptrdiff_t j1) {
+            for (std::ptrdiff_t j = j0; j < j1; ++j) {
+                std::array<Scalar, 5> sum = {{0., 0., 0., 0., 0.}};
+                const Scalar *x = X.col(j).data();
+                const Scalar *y = Y.col(j).data();
+                const Scalar *y_old = Y_old.col(j).data();
+                const Scalar *z = Z.col(j).data();
+                for (int i = 0; i < m; ++i) {
+                    const Scalar d_P = x[i] - y[i];
+                    const Scalar d_D = y_old[i] - y[i];
+                    sum[0] += d_P*d_P;
+                    sum[1] += d_D*d_D;
+                    sum[2] += x[i]*x[i];
+                    sum[3] += y[i]*y[i];
+                    sum[4] += z[i]*z[i];
+                }
+                partial[j] = sum;
+            }
+        });
+        std::array<Scalar, 5> sum = {{0., 0., 0., 0., 0.}};
+        for (int j = 0; j < n; ++j) {
+            for (int k = 0; k < 5; ++k) {
+                sum[k] += partial[j][k];
+            }
+        }
+
+        Scalar err_P = std::sqrt(sum[0]);
+        Scalar err_D = rho*std::sqrt(sum[1]);
+        Scalar tor_P = sqrtmn * abs_tol + rel_tol * std::sqrt(std::max(sum[2], sum[3]));
+        Scalar tor_D = sqrtmn * abs_tol + rel_tol * std::sqrt(sum[4]);
 
         return err_P < tor_P && err_D < tor_D;
     }
     void log(const std::string &id="") const
     {
-        std::ofstream fout(logfile+id);
-        out(fout, X);
+        if (binary_log) {
+            std::ofstream fout(logfile+id, std::ios::binary);
+            out_binary(fout, X);
+            fout.close();
+        } else {
+            std::ofstream fout(logfile+id);
+            out(fout, X);
+            fout.close();
+        }
+    }
+    /*! @brief チェックポイントがこの問題のものか確かめるための値．(m, n, 観測数, γn, γr, γc, ρ)
+    */
+    Eigen::Matrix<double, 7, 1> checkpoint_signature() const
+    {
+        Eigen::Matrix<double, 7, 1> signature;
+        signature << m, n, _problem->M.nonZeros(), gamma_n, gamma_r, gamma_c, rho;
+        return signature;
+    }
+    /*! @brief (問題の署名, 反復回数, X, Y, Z)をバイナリで保存する．
+        書き込み途中で落ちても前のチェックポイントが残るよう，一時ファイルに書いてから置き換える
+    */
+    bool save_checkpoint(const std::string &filename, const int iteration) const
+    {
+        const std::string tmpname = filename + ".tmp";
+        std::ofstream fout(tmpname, std::ios::binary);
+        Eigen::Matrix<int, 1, 1> iter;
+        iter << iteration;
+        out_binary(fout, checkpoint_signature());
+        out_binary(fout, iter);
+        out_binary(fout, X);
+        out_binary(fout, Y);
+        out_binary(fout, Z);
         fout.close();
+        if (fout.fail()) {
+            return false;
+        }
+        return std::rename(tmpname.c_str(), filename.c_str()) == 0;
     }
-    void go()
+    /*! @brief save_checkpointで保存した状態を読む．init()の後に呼ぶこと
+        @param iteration 保存時の反復回数
+        @return 読めたか．形やハイパーパラメータが違う問題のものは読まない．失敗した場合は状態を変えない
+    */
+    bool load_checkpoint(const std::string &filename, int &iteration)
     {
-        init();
-        for (int i = 0; i < max_rep; i++) {
-            _PRINT(i)
+        std::ifstream fin(filename, std::ios::binary);
+        Eigen::Matrix<double, 7, 1> signature;
+        Eigen::Matrix<int, 1, 1> iter;
+        M_type X_, Y_, Z_;
+        in_binary(fin, signature);
+        if (fin.fail() || signature != checkpoint_signature()) {
+            return false;
+        }
+        in_binary(fin, iter);
+        in_binary(fin, X_);
+        in_binary(fin, Y_);
+        in_binary(fin, Z_);
+        if (fin.fail() || X_.rows() != m || X_.cols() != n || Y_.rows() != m || Y_.cols() != n || Z_.rows() != m || Z_.cols() != n) {
+            return false;
+        }
+        iteration = iter(0);
+        X = X_;
+        Y = Y_old = Y_;
+        Z = Z_;
+        return true;
+    }
+    /*! @brief 観測を追加する．init()の後に呼ぶこと．
+        MとAを更新し，CG前処理は変化した対角成分だけを直す．(X, Y, Z)はそのまま残すので，
+        続けてrun()を呼べば現在の解からADMMを再開できる
+        @param trivec (行, 列, 値)．既に観測済みの位置は上書きする．同じ位置が複数あれば後のものを使う
+    */
+    void add_observations(const std::vector<Eigen::Triplet<Scalar>> &trivec)
+    {
+        // 共有している問題は書き換えない
+        assert(_problem == this);
+        SM_type D(m, n);
+        D.setFromTriplets(trivec.begin(), trivec.end(), [](const Scalar &, const Scalar &b) { return b; });
+        SM_type P(D);
+        for (int j = 0; j < P.outerSize(); ++j) {
+            for (typename SM_type::InnerIterator it(P, j); it; ++it)
+            {
+                it.valueRef() = 1.;
+            }
+        }
+        // 追加位置の古い値を消してから足す
+        M = M - M.cwiseProduct(P) + D;
+        M.prune(static_cast<Scalar>(0));
+        A = make_mask(M);
+
+        for (int j = 0; j < D.outerSize(); ++j) {
+            for (typename SM_type::InnerIterator it(D, j); it; ++it)
+            {
+                const int i = it.row();
+                cg.preconditioner().update_diagonal(m*j+i, coef.diagonal_coeff(i, j));
+            }
+        }
+    }
+    /*! @brief 別の解から始める．init()の後に呼ぶこと．正則化パスに沿って隣の解を初期値にするため
+    */
+    void warm_start_from(const MC &other)
+    {
+        X = other.X;
+        Y = Y_old = other.Y;
+        // Zはスケール化した双対変数なのでρの比で直す
+        Z = (other.rho/rho)*other.Z;
+    }
+    /*! @brief 目的関数 1/2||A∘(X-M)||^2 + γn||X||_* + γr/2 tr(X^T Lr X) + γc/2 tr(X Lc X^T)．
+        ||X||_*には直前のX_optで求めたnuを使う
+    */
+    Scalar objective() const
+    {
+        const MC &p = *_problem;
+        Scalar fit = 0.;
+        for (int j = 0; j < p.A.outerSize(); ++j) {
+            for (typename SM_type::InnerIterator it(p.A, j); it; ++it)
+            {
+                const Scalar r = X(it.row(), j) - p.M.coeff(it.row(), j);
+                fit += it.value()*r*r;
+            }
+        }
+        const Scalar smooth_r = (gamma_r != 0) ? X.cwiseProduct(p.Lr*X).sum() : 0.;
+        const Scalar smooth_c = (gamma_c != 0) ? X.cwiseProduct(X*p.Lc).sum() : 0.;
+
+        return 0.5*fit + gamma_n*nu + 0.5*gamma_r*smooth_r + 0.5*gamma_c*smooth_c;
+    }
+    /*! @brief 現在の(X, Y, Z)からADMMを回す．収束するか反復上限に達したらチェックポイントを消す
+        @param first 最初の反復番号
+    */
+    void run(const int first=0)
+    {
+        for (int i = first; i < max_rep; i++) {
+            if (verbose) {
+                _PRINT(i)
+            }
             step();
+            if (verbose) {
+                _PRINT(cg_iterations.back())
+            }
             #ifdef LOGGER
             log(std::to_string(i));
             #endif
+            if (!checkpoint_file.empty() && checkpoint_interval > 0 && (i + 1) % checkpoint_interval == 0) {
+                save_checkpoint(checkpoint_file, i);
+            }
             if (stop_cond()) {
                 break;
             }
         }
+        // 終わった実行を次の実行が再開しないように
+        if (!checkpoint_file.empty()) {
+            std::remove(checkpoint_file.c_str());
+        }
+    }
+    void go()
+    {
+        init();
+        int first = 0;
+        if (!checkpoint_file.empty() && load_checkpoint(checkpoint_file, first)) {
+            // 保存した反復の続きから
+            first++;
+        }
+        run(first);
     }
 };
 
@@ -196,3 +425,21 @@ template <typename T>
 T MC<T>::rel_tol = 1.e-6;
 template <typename T>
 std::string MC<T>::logfile = "X.log";
+template <typename T>
+int MC<T>::prox_rank = 0;
+template <typename T>
+bool MC<T>::cg_warm_start = false;
+template <typename T>
+Precond MC<T>::cg_precond = Precond::JACOBI;
+template <typename T>
+int MC<T>::threads = 1;
+template <typename T>
+bool MC<T>::binary_log = false;
+template <typename T>
+std::string MC<T>::checkpoint_file = "";
+template <typename T>
+int MC<T>::checkpoint_interval = 0;
+template <typename T>
+bool MC<T>::verbose = true;
+
+#endif
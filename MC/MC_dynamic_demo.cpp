@@ -5,6 +5,7 @@
 #include <debug>
 #include <os>
 #include "MC_dynamic.hpp"
+#include "MC_io.hpp"
 
 using Scalar = double;
 using M_type = Eigen::MatrixX<Scalar>;
@@ -27,39 +28,50 @@ int main(int argc, char *argv[])
     const std::string project = argv[3];
     const std::string log_dirname = (argc == 5) ? os::path::join(project, argv[4]) : os::path::join(project, "log");
 
-    const std::string M_filename = os::path::join(project, "M.mat");
-    const std::string Lr_filename = os::path::join(project, "Lr.mat");
-    const std::string Lc_filename = os::path::join(project, "Lc.mat");
     const std::string prob_param_filename = "prob_param";
     const std::string solver_param_filename = "solver_param";
     const std::string X_filename = os::path::join(project, "X.mat");
+    // 実行ごとに分けるため，ログディレクトリに置く
+    const std::string checkpoint_filename = os::path::join(log_dirname, "checkpoint.bin");
 
     MC<Scalar> mc(m, n);
 
-    std::ifstream fin(M_filename);
-    in(fin, mc.M);
-    fin.close();
+    load_sparse(project, "M", mc.M);
 
     // mc.M = (mc.M.array() - mc.M.mean()).matrix();
     mc.A = make_mask(mc.M);
 
-    fin.open(Lr_filename);
-    in(fin, mc.Lr);
-    fin.close();
-
-    fin.open(Lc_filename);
-    in(fin, mc.Lc);
-    fin.close();
+    load_sparse(project, "Lr", mc.Lr);
+    load_sparse(project, "Lc", mc.Lc);
 
-    fin.open(prob_param_filename);
+    std::ifstream fin(prob_param_filename);
     fin >> mc.gamma_n >> mc.gamma_r >> mc.gamma_c >> mc.rho;
     fin.close();
 
     fin.open(solver_param_filename);
     fin >> MC<Scalar>::max_rep >> MC<Scalar>::abs_tol >> MC<Scalar>::rel_tol;
+    // 以下は省略可能．低ランク近接写像の初期探索次元，CGのウォームスタート(0/1)，前処理(0: Jacobi, 1: 不完全Cholesky)，スレッド数，チェックポイント間隔
+    int cg_warm_start = 0;
+    int cg_precond = 0;
+    if (!(fin >> MC<Scalar>::prox_rank)) {
+        MC<Scalar>::prox_rank = 0;
+    }
+    fin >> cg_warm_start >> cg_precond >> MC<Scalar>::threads >> MC<Scalar>::checkpoint_interval;
+    if (MC<Scalar>::threads < 1) {
+        MC<Scalar>::threads = 1;
+    }
+    if (MC<Scalar>::checkpoint_interval > 0) {
+        // 同じ問題・ハイパーパラメータのものが既にあれば続きから再開する
+        MC<Scalar>::checkpoint_file = checkpoint_filename;
+    }
+    MC<Scalar>::cg_warm_start = (cg_warm_start != 0);
+    MC<Scalar>::cg_precond = (cg_precond == 1) ? Precond::INCOMPLETE_CHOLESKY : Precond::JACOBI;
     fin.close();
 
     MC<Scalar>::logfile = os::path::join(log_dirname, "X");
+    #ifdef BINARY_LOGGER
+    MC<Scalar>::binary_log = true;
+    #endif
 
     mc.go();
 
@@ -0,0 +1,61 @@
+/*! @file
+    @brief MCの入力ファイルの読み込み
+    @author templateaholic10
+*/
+#ifndef MC_IO_HPP
+#define MC_IO_HPP
+
+#include <fstream>
+#include <string>
+#include <eigensparse_io>
+#include <eigen_bin>
+#include <os>
+#include <sys/stat.h>
+
+/*! @brief ファイルの(バイト数, 更新時刻[ns])．なければ(-1, -1)
+*/
+inline Eigen::Matrix<long, 2, 1> file_stamp(const std::string &filename)
+{
+    Eigen::Matrix<long, 2, 1> stamp;
+    struct stat st;
+    if (::stat(filename.c_str(), &st) != 0) {
+        stamp << -1, -1;
+    } else {
+        stamp << static_cast<long>(st.st_size), static_cast<long>(st.st_mtim.tv_sec)*1000000000L + st.st_mtim.tv_nsec;
+    }
+    return stamp;
+}
+
+/*! @brief 疎行列を読む．name.binがあればmmapして読み，なければname.matをテキストとして読んでname.binを書いておく．
+    name.binには行列の後ろに書いたときのname.matのfile_stampを続けて書き，name.matが変わっていれば読み直す．
+    name.matがなければname.binをそのまま使う
+*/
+template <typename T>
+void load_sparse(const std::string &project, const std::string &name, Eigen::SMatrix<T> &M)
+{
+    const std::string mat_filename = os::path::join(project, name + ".mat");
+    const std::string bin_filename = os::path::join(project, name + ".bin");
+    const Eigen::Matrix<long, 2, 1> source = file_stamp(mat_filename);
+    Mapped_sparse<T> mapped;
+    if (mapped.open(bin_filename) && mapped.matrix().rows() == M.rows() && mapped.matrix().cols() == M.cols()) {
+        std::ifstream fin(bin_filename, std::ios::binary);
+        fin.seekg(mapped.next_offset());
+        Eigen::Matrix<long, 2, 1> stamp;
+        in_binary(fin, stamp);
+        if (source(0) < 0 || (!fin.fail() && stamp == source)) {
+            M = mapped.matrix();
+            return;
+        }
+    }
+
+    std::ifstream fin(mat_filename);
+    in(fin, M);
+    fin.close();
+
+    std::ofstream fout(bin_filename, std::ios::binary);
+    out_binary(fout, M);
+    out_binary(fout, source);
+    fout.close();
+}
+
+#endif
@@ -0,0 +1,120 @@
+/*! @file
+    @brief MCのハイパーパラメータ(γn, γr, γc, ρ)の格子掃引
+    @author templateaholic10
+*/
+#ifndef MC_SWEEP_HPP
+#define MC_SWEEP_HPP
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <memory>
+#include <numeric>
+#include <vector>
+#include <thread_pool>
+#include <timer>
+#include "MC_dynamic.hpp"
+
+/*! @struct
+    @brief 格子点1つ分の結果
+*/
+template <typename T>
+struct Sweep_result {
+    T gamma_n;
+    T gamma_r;
+    T gamma_c;
+    T rho;
+    T objective;
+    T nu;           // 核ノルム
+    int iterations; // ADMMの反復回数
+    int time;       // ミリ秒
+};
+
+/*! @brief 格子点ごとに呼ぶコールバックの型．sweepの引数でTを推論させないためにメタ関数にしておく
+*/
+template <typename T>
+struct Sweep_callback {
+    using type = std::function <void(const Sweep_result <T>&, const MC <T>&)>;
+};
+
+/*! @brief 格子 gamma_ns×gamma_rs×gamma_cs×rhos 上でMCを解く．
+    観測とラプラシアンはproblemのものを全格子点で共有する(MC::share)．
+    (γr, γc, ρ)が同じ格子点はγnの大きい順に1本の正則化パスとして逐次に解き，直前の解から始める．
+    パスどうしはスレッドプール上で並列に解く．
+    同時に複数のMCが走るので，MC<T>::checkpoint_fileは空にし，LOGGERは定義しないこと
+    @param problem M, A, Lr, Lcを設定したMC
+    @param threads 同時に解くパスの数
+    @param on_result 格子点が解けるたびにワーカースレッドから呼ばれる．Xの保存などに使う
+    @return gamma_ns, gamma_rs, gamma_cs, rhosの順の辞書式(rhosが最も内側)に並べた結果
+*/
+template <typename T>
+std::vector <Sweep_result <T> > sweep(const MC <T> &problem, const std::vector <T> &gamma_ns, const std::vector <T> &gamma_rs, const std::vector <T> &gamma_cs, const std::vector <T> &rhos,
+                                      const int threads=1, typename Sweep_callback <T>::type on_result=nullptr)
+{
+    const std::size_t N = gamma_ns.size();
+    const std::size_t R = gamma_rs.size();
+    const std::size_t C = gamma_cs.size();
+    const std::size_t P = rhos.size();
+    std::vector <Sweep_result <T> > results(N*R*C*P);
+
+    // γnの大きい順．解が低ランクな側から始める
+    std::vector <std::size_t> order(N);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&gamma_ns](const std::size_t a, const std::size_t b) {
+        return gamma_ns[a] > gamma_ns[b];
+    });
+
+    auto solve_path = [&](const std::size_t ir, const std::size_t ic, const std::size_t ip) {
+        std::unique_ptr <MC <T> > prev;
+        for (const std::size_t in : order) {
+            std::unique_ptr <MC <T> > mc(new MC <T>(problem.m, problem.n));
+            mc->share(problem);
+            mc->gamma_n = gamma_ns[in];
+            mc->gamma_r = gamma_rs[ir];
+            mc->gamma_c = gamma_cs[ic];
+            mc->rho     = rhos[ip];
+
+            Timer <> timer;
+            mc->init();
+            if (prev) {
+                mc->warm_start_from(*prev);
+            }
+            mc->run();
+
+            Sweep_result <T> &result = results[((in*R + ir)*C + ic)*P + ip];
+            result.gamma_n    = mc->gamma_n;
+            result.gamma_r    = mc->gamma_r;
+            result.gamma_c    = mc->gamma_c;
+            result.rho        = mc->rho;
+            result.objective  = mc->objective();
+            result.nu         = mc->nu;
+            result.iterations = mc->cg_iterations.size();
+            result.time       = timer.elapsed();
+            if (on_result) {
+                on_result(result, *mc);
+            }
+            prev = std::move(mc);
+        }
+    };
+
+    // 呼び出し元スレッドは待つだけなのでワーカーはthreads個
+    parallel::Thread_pool pool(std::max(threads, 1));
+    std::vector <std::future <void> > futures;
+    futures.reserve(R*C*P);
+    for (std::size_t ir = 0; ir < R; ir++) {
+        for (std::size_t ic = 0; ic < C; ic++) {
+            for (std::size_t ip = 0; ip < P; ip++) {
+                futures.push_back(pool.submit([&solve_path, ir, ic, ip]() {
+                    solve_path(ir, ic, ip);
+                }));
+            }
+        }
+    }
+    for (auto &future : futures) {
+        future.get();
+    }
+
+    return results;
+}
+
+#endif
@@ -0,0 +1,112 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <eigen_io>
+#include <debug>
+#include <os>
+#include "MC_dynamic.hpp"
+#include "MC_io.hpp"
+#include "MC_sweep.hpp"
+
+using Scalar = double;
+
+/*! @brief 1行に空白区切りで並んだ値を読む
+*/
+std::vector<Scalar> read_list(std::istream &is)
+{
+    std::string line;
+    std::getline(is, line);
+    std::istringstream iss(line);
+    std::vector<Scalar> retval;
+    Scalar x;
+    while (iss >> x) {
+        retval.push_back(x);
+    }
+    return retval;
+}
+
+/*! @brief batch.ipynbと同じ "γn_γr_γc_ρ" 形式のディレクトリ名
+*/
+std::string params_str(const Sweep_result<Scalar> &result)
+{
+    std::ostringstream oss;
+    oss << result.gamma_n << "_" << result.gamma_r << "_" << result.gamma_c << "_" << result.rho;
+    return oss.str();
+}
+
+/*! @brief this m n project
+    sweep_paramの4行にγn, γr, γc, ρの候補を空白区切りで並べる．
+    格子点ごとのXはproject/γn_γr_γc_ρ/X.matに，一覧はproject/sweep_summary.tsvに書く
+*/
+int main(int argc, char *argv[])
+{
+    if (argc < 4) {
+        std::cerr << "MC_sweep_demo [m] [n] [project] [(option)threads]" << std::endl;
+        return 1;
+    }
+    const int m = atoi(argv[1]);
+    const int n = atoi(argv[2]);
+    const std::string project = argv[3];
+    const int threads = (argc == 5) ? atoi(argv[4]) : static_cast<int>(parallel::hardware_threads());
+
+    const std::string sweep_param_filename = "sweep_param";
+    const std::string solver_param_filename = "solver_param";
+    const std::string summary_filename = os::path::join(project, "sweep_summary.tsv");
+
+    // 観測とラプラシアンは一度だけ読み，全格子点で共有する
+    MC<Scalar> problem(m, n);
+    load_sparse(project, "M", problem.M);
+    problem.A = make_mask(problem.M);
+    load_sparse(project, "Lr", problem.Lr);
+    load_sparse(project, "Lc", problem.Lc);
+
+    std::ifstream fin(sweep_param_filename);
+    const std::vector<Scalar> gamma_ns = read_list(fin);
+    const std::vector<Scalar> gamma_rs = read_list(fin);
+    const std::vector<Scalar> gamma_cs = read_list(fin);
+    const std::vector<Scalar> rhos = read_list(fin);
+    fin.close();
+
+    fin.open(solver_param_filename);
+    fin >> MC<Scalar>::max_rep >> MC<Scalar>::abs_tol >> MC<Scalar>::rel_tol;
+    // 以下は省略可能．低ランク近接写像の初期探索次元，CGのウォームスタート(0/1)，前処理(0: Jacobi, 1: 不完全Cholesky)
+    int cg_warm_start = 0;
+    int cg_precond = 0;
+    if (!(fin >> MC<Scalar>::prox_rank)) {
+        MC<Scalar>::prox_rank = 0;
+    }
+    fin >> cg_warm_start >> cg_precond;
+    MC<Scalar>::cg_warm_start = (cg_warm_start != 0);
+    MC<Scalar>::cg_precond = (cg_precond == 1) ? Precond::INCOMPLETE_CHOLESKY : Precond::JACOBI;
+    fin.close();
+
+    // 格子点どうしで並列化するので，1つのMCの中は逐次
+    MC<Scalar>::threads = 1;
+    MC<Scalar>::verbose = false;
+    MC<Scalar>::checkpoint_file = "";
+
+    const std::vector<Sweep_result<Scalar>> results = sweep(problem, gamma_ns, gamma_rs, gamma_cs, rhos, threads,
+        [&project](const Sweep_result<Scalar> &result, const MC<Scalar> &mc) {
+            const std::string dirname = os::path::join(project, params_str(result));
+            ::mkdir(dirname.c_str(), 0755);
+            std::ofstream fout(os::path::join(dirname, "X.mat"));
+            out(fout, mc.X);
+            fout.close();
+        });
+
+    std::ofstream fout(summary_filename);
+    fout << "gamma_n\tgamma_r\tgamma_c\trho\tobjective\tnu\titerations\ttime[ms]" << std::endl;
+    for (const auto &result : results) {
+        fout << result.gamma_n << '\t' << result.gamma_r << '\t' << result.gamma_c << '\t' << result.rho << '\t'
+             << result.objective << '\t' << result.nu << '\t' << result.iterations << '\t' << result.time << std::endl;
+    }
+    fout.close();
+
+    std::ifstream summary(summary_filename);
+    std::cout << summary.rdbuf();
+
+    return 0;
+}
@@ -0,0 +1,320 @@
+/*! @file
+    @brief MCのY更新で解く線形系 diag(A) + γr(Lr⊗I) + γc(I⊗Lc) + ρI を行列を作らずに作用させる演算子
+    @author templateaholic10
+*/
+#ifndef KRONECKER_SUM_HPP
+#define KRONECKER_SUM_HPP
+
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <Eigen/IterativeLinearSolvers>
+#include <thread_pool>
+
+template <typename T>
+class Kronecker_sum;
+
+namespace Eigen {
+    namespace internal {
+        // Eigen::SparseMatrixの性質を借りる
+        template <typename T>
+        struct traits <Kronecker_sum <T> >
+            : public Eigen::internal::traits <Eigen::SparseMatrix <T> >
+        {};
+    }
+}
+
+/*! @class
+    @brief Kronecker和の行列自由(matrix-free)演算子．
+    vec(Y)に対して vec(A∘Y + γr*Lr*Y + γc*Y*Lc + ρ*Y) を返す．
+    (mn)×(mn)行列を作らないのでメモリはO(nnz(A)+nnz(Lr)+nnz(Lc)+mn)で済む．
+    ベクトル化は列優先(インデックスm*j+i)．Lr，Lcは対称であること．
+    A，Lr，Lcは参照で保持するので，attachしたオブジェクトより長生きさせないこと
+*/
+template <typename T>
+class Kronecker_sum
+    : public Eigen::EigenBase <Kronecker_sum <T> >
+{
+public:
+    using Scalar       = T;
+    using RealScalar   = T;
+    using StorageIndex = int;
+    using M_type       = Eigen::Matrix <Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+    using V_type       = Eigen::Matrix <Scalar, Eigen::Dynamic, 1>;
+    using SM_type      = Eigen::SparseMatrix <Scalar>;
+    enum {
+        ColsAtCompileTime    = Eigen::Dynamic,
+        MaxColsAtCompileTime = Eigen::Dynamic,
+        IsRowMajor           = false
+    };
+private:
+    int _m;
+    int _n;
+    const SM_type *_A;
+    const SM_type *_Lr;
+    const SM_type *_Lc;
+    Scalar _gamma_r;
+    Scalar _gamma_c;
+    Scalar _rho;
+    parallel::Thread_pool *_pool;
+public:
+    Kronecker_sum()
+        : _m(0), _n(0), _A(nullptr), _Lr(nullptr), _Lc(nullptr), _gamma_r(0), _gamma_c(0), _rho(0), _pool(nullptr)
+    {
+    }
+
+    /*! @brief 係数を結びつける
+        @param A マスク行列(m×n)
+        @param Lr 行グラフラプラシアン(m×m)
+        @param Lc 列グラフラプラシアン(n×n)
+        @param pool 作用を列ブロックごとに並列化するスレッドプール．nullptrのとき逐次
+    */
+    void attach(const SM_type &A, const SM_type &Lr, const SM_type &Lc, const Scalar gamma_r, const Scalar gamma_c, const Scalar rho, parallel::Thread_pool *pool=nullptr)
+    {
+        _m       = A.rows();
+        _n       = A.cols();
+        _A       = &A;
+        _Lr      = &Lr;
+        _Lc      = &Lc;
+        _gamma_r = gamma_r;
+        _gamma_c = gamma_c;
+        _rho     = rho;
+        _pool    = pool;
+    }
+
+    Eigen::Index rows() const
+    {
+        return static_cast <Eigen::Index>(_m)*_n;
+    }
+
+    Eigen::Index cols() const
+    {
+        return static_cast <Eigen::Index>(_m)*_n;
+    }
+
+    template <typename Rhs>
+    Eigen::Product <Kronecker_sum, Rhs, Eigen::AliasFreeProduct> operator*(const Eigen::MatrixBase <Rhs> &x) const
+    {
+        return Eigen::Product <Kronecker_sum, Rhs, Eigen::AliasFreeProduct>(*this, x.derived());
+    }
+
+    /*! @brief y += alpha*(演算子)*x
+        @param x m*n次元ベクトル
+        @param y m*n次元ベクトル
+    */
+    void apply_add(const Eigen::Ref <const V_type> &x, Eigen::Ref <V_type> y, const Scalar alpha) const
+    {
+        Eigen::Map <const M_type> X(x.data(), _m, _n);
+        Eigen::Map <M_type>       R(y.data(), _m, _n);
+        // 結果の列ブロックごとに独立に計算できる
+        parallel::for_range(_pool, 0, _n, [&](const std::ptrdiff_t j0, const std::ptrdiff_t j1) {
+            const std::ptrdiff_t cols = j1 - j0;
+            auto Rb = R.middleCols(j0, cols);
+            Rb += (alpha*_rho)*X.middleCols(j0, cols);
+            if (_gamma_r != 0) {
+                Rb.noalias() += (alpha*_gamma_r)*((*_Lr)*X.middleCols(j0, cols));
+            }
+            if (_gamma_c != 0) {
+                Rb.noalias() += (alpha*_gamma_c)*(X*_Lc->middleCols(j0, cols));
+            }
+            for (std::ptrdiff_t j = j0; j < j1; ++j) {
+                for (typename SM_type::InnerIterator it(*_A, j); it; ++it)
+                {
+                    R(it.row(), j) += alpha*it.value()*X(it.row(), j);
+                }
+            }
+        });
+    }
+
+    /*! @brief 対角成分 A(i,j) + γr*Lr(i,i) + γc*Lc(j,j) + ρ を列優先で並べたもの
+    */
+    V_type diagonal() const
+    {
+        V_type retval(rows());
+        Eigen::Map <M_type> D(retval.data(), _m, _n);
+        const V_type dr = _Lr->diagonal();
+        const V_type dc = _Lc->diagonal();
+        for (int j = 0; j < _n; j++) {
+            D.col(j).array() = _rho + _gamma_r*dr.array() + _gamma_c*dc(j);
+        }
+        for (int j = 0; j < _A->outerSize(); ++j) {
+            for (typename SM_type::InnerIterator it(*_A, j); it; ++it)
+            {
+                D(it.row(), j) += it.value();
+            }
+        }
+
+        return retval;
+    }
+
+    /*! @brief 対角成分の1つ．観測を追加したときに前処理の該当箇所だけを直すのに使う
+    */
+    Scalar diagonal_coeff(const int i, const int j) const
+    {
+        return _rho + _gamma_r*_Lr->coeff(i, i) + _gamma_c*_Lc->coeff(j, j) + _A->coeff(i, j);
+    }
+
+    /*! @brief 係数行列を疎行列として組み立てる．前処理の不完全Cholesky分解用．
+        非零要素数はO(n*nnz(Lr) + m*nnz(Lc) + mn)
+    */
+    SM_type assemble() const
+    {
+        using Tri_type = Eigen::Triplet <Scalar>;
+        std::vector <Tri_type> trivec;
+        trivec.reserve(static_cast <std::size_t>(_n)*_Lr->nonZeros() + static_cast <std::size_t>(_m)*_Lc->nonZeros() + rows() + _A->nonZeros());
+        for (int j = 0; j < _n; j++) {
+            for (int i = 0; i < _m; i++) {
+                trivec.push_back(Tri_type(_m*j+i, _m*j+i, _rho));
+            }
+        }
+        for (int j = 0; j < _A->outerSize(); ++j) {
+            for (typename SM_type::InnerIterator it(*_A, j); it; ++it)
+            {
+                trivec.push_back(Tri_type(_m*j+it.row(), _m*j+it.row(), it.value()));
+            }
+        }
+        // γr*(Lr*Y)の寄与．列jのブロック対角
+        for (int k = 0; k < _Lr->outerSize(); ++k) {
+            for (typename SM_type::InnerIterator it(*_Lr, k); it; ++it)
+            {
+                for (int j = 0; j < _n; j++) {
+                    trivec.push_back(Tri_type(_m*j+it.row(), _m*j+k, _gamma_r*it.value()));
+                }
+            }
+        }
+        // γc*(Y*Lc)の寄与．列lと列jを結ぶ対角ブロック
+        for (int j = 0; j < _Lc->outerSize(); ++j) {
+            for (typename SM_type::InnerIterator it(*_Lc, j); it; ++it)
+            {
+                for (int i = 0; i < _m; i++) {
+                    trivec.push_back(Tri_type(_m*j+i, _m*it.row()+i, _gamma_c*it.value()));
+                }
+            }
+        }
+        SM_type retval(rows(), cols());
+        retval.setFromTriplets(trivec.begin(), trivec.end());
+
+        return retval;
+    }
+};
+
+namespace Eigen {
+    namespace internal {
+        template <typename T, typename Rhs>
+        struct generic_product_impl <Kronecker_sum <T>, Rhs, SparseShape, DenseShape, GemvProduct>
+            : generic_product_impl_base <Kronecker_sum <T>, Rhs, generic_product_impl <Kronecker_sum <T>, Rhs> >
+        {
+            using Scalar = typename Product <Kronecker_sum <T>, Rhs>::Scalar;
+
+            template <typename Dest>
+            static void scaleAndAddTo(Dest &dst, const Kronecker_sum <T> &lhs, const Rhs &rhs, const Scalar &alpha)
+            {
+                lhs.apply_add(rhs, dst, alpha);
+            }
+        };
+    }
+}
+
+/*! @enum
+    @brief Kronecker_sum用前処理の種類
+*/
+enum class Precond {
+    JACOBI,              // 対角(Jacobi)．Eigen::DiagonalPreconditionerと同じ
+    INCOMPLETE_CHOLESKY, // 係数行列を組み立てて不完全Cholesky分解する
+};
+
+/*! @class
+    @brief Kronecker_sum用の前処理．kindで種類を選び，compute前に設定すること
+*/
+template <typename T>
+class Kronecker_sum_preconditioner {
+public:
+    using Scalar       = T;
+    using StorageIndex = int;
+    using V_type       = Eigen::Matrix <Scalar, Eigen::Dynamic, 1>;
+    using SM_type      = Eigen::SparseMatrix <Scalar>;
+    enum {
+        ColsAtCompileTime    = Eigen::Dynamic,
+        MaxColsAtCompileTime = Eigen::Dynamic
+    };
+public:
+    Precond kind;
+private:
+    V_type _invdiag;
+    Eigen::IncompleteCholesky <Scalar, Eigen::Lower, Eigen::AMDOrdering <StorageIndex> > _ic;
+    Eigen::ComputationInfo _info;
+public:
+    Kronecker_sum_preconditioner()
+        : kind(Precond::JACOBI), _info(Eigen::Success)
+    {
+    }
+
+    template <typename MatType>
+    explicit Kronecker_sum_preconditioner(const MatType &mat)
+        : kind(Precond::JACOBI), _info(Eigen::Success)
+    {
+        compute(mat);
+    }
+
+    Eigen::Index rows() const
+    {
+        return _invdiag.size();
+    }
+
+    Eigen::Index cols() const
+    {
+        return _invdiag.size();
+    }
+
+    template <typename MatType>
+    Kronecker_sum_preconditioner &analyzePattern(const MatType &)
+    {
+        return *this;
+    }
+
+    template <typename MatType>
+    Kronecker_sum_preconditioner &factorize(const MatType &mat)
+    {
+        _invdiag = mat.diagonal().cwiseInverse();
+        _info    = Eigen::Success;
+        if (kind == Precond::INCOMPLETE_CHOLESKY) {
+            _ic.compute(mat.assemble());
+            _info = _ic.info();
+        }
+
+        return *this;
+    }
+
+    /*! @brief Jacobi前処理の対角成分を1つだけ差し替える．
+        不完全Cholesky分解は作り直さない(古い分解のままでも前処理としては有効)
+        @param k 列優先のインデックス
+        @param d 新しい対角成分
+    */
+    void update_diagonal(const Eigen::Index k, const Scalar d)
+    {
+        _invdiag[k] = static_cast <Scalar>(1)/d;
+    }
+
+    template <typename MatType>
+    Kronecker_sum_preconditioner &compute(const MatType &mat)
+    {
+        return factorize(mat);
+    }
+
+    template <typename Rhs>
+    V_type solve(const Rhs &b) const
+    {
+        if (kind == Precond::INCOMPLETE_CHOLESKY) {
+            return _ic.solve(b);
+        }
+
+        return _invdiag.cwiseProduct(b);
+    }
+
+    Eigen::ComputationInfo info()
+    {
+        return _info;
+    }
+};
+
+#endif
@@ -0,0 +1,132 @@
+/*! @file
+    @brief 核ノルムの近接写像を上位特異値だけで計算するための乱択部分空間法
+    @author templateaholic10
+*/
+#ifndef LOWRANK_PROX_HPP
+#define LOWRANK_PROX_HPP
+
+#include <algorithm>
+#include <Eigen/Core>
+#include <Eigen/QR>
+#include <Eigen/SVD>
+#include <exrandom>
+
+/*! @class
+    @brief 核ノルムの近接写像 prox_{l||.||_*}(M) の低ランク版．
+    しきい値lを超える特異三つ組だけを乱択値域探索(部分空間反復つき)で求める．
+    しきい値を超える特異値の数が探索次元に達したら次元を倍にしてやり直す．
+    前回の右特異ベクトルを次回の試行行列の先頭に使うウォームスタートを行う．
+    1回あたりO(mnk)．探索次元がmin(m, n)に達した場合は完全SVDと同じ結果になる
+    @tparam T 要素型
+*/
+template <typename T>
+class Lowrank_prox {
+public:
+    using Scalar = T;
+    using M_type = Eigen::Matrix <Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+    using V_type = Eigen::Matrix <Scalar, Eigen::Dynamic, 1>;
+public:
+    int rank;       // 直近のしきい値超え特異値の数
+    int oversample; // 探索次元の余裕
+    int power_iter; // 部分空間反復の回数
+private:
+    M_type _V; // 前回の右特異ベクトル(n×rank)
+    std::Gaussian <Scalar> _gaussian;
+public:
+    /*! @param initial_rank 最初の探索次元
+        @param seed 試行行列の乱数シード．既定値は再現性のため固定
+    */
+    explicit Lowrank_prox(const int initial_rank=10, const int oversample_=5, const int power_iter_=1, const std::random_device::result_type seed=0)
+        : rank(initial_rank), oversample(oversample_), power_iter(power_iter_), _gaussian(0., 1., seed)
+    {
+    }
+
+    /*! @brief ウォームスタート用の部分空間を捨てる
+    */
+    void reset(const int initial_rank=10)
+    {
+        rank = initial_rank;
+        _V.resize(0, 0);
+    }
+
+    /*! @brief 近接写像
+        @param M 入力行列
+        @param l しきい値
+        @param nu 結果の核ノルム
+    */
+    M_type operator()(const M_type &M, const Scalar &l, Scalar &nu)
+    {
+        const int m     = M.rows();
+        const int n     = M.cols();
+        const int minmn = std::min(m, n);
+        int       k     = std::max(rank, 1);
+        for (;; ) {
+            const int p = std::min(k + oversample, minmn);
+            if (p >= minmn) {
+                return full(M, l, nu);
+            }
+
+            // 試行行列．先頭に前回の右特異ベクトルを置く
+            M_type    Omega(n, p);
+            const int warm = (_V.rows() == n) ? std::min<int>(_V.cols(), p) : 0;
+            if (warm > 0) {
+                Omega.leftCols(warm) = _V.leftCols(warm);
+            }
+            for (int j = warm; j < p; j++) {
+                for (int i = 0; i < n; i++) {
+                    Omega(i, j) = _gaussian();
+                }
+            }
+
+            M_type Q = orthonormalize(M*Omega);
+            for (int q = 0; q < power_iter; q++) {
+                const M_type W = orthonormalize(M.transpose()*Q);
+                Q = orthonormalize(M*W);
+            }
+            const M_type B = Q.transpose()*M;
+            Eigen::JacobiSVD <M_type> svd(B, Eigen::ComputeThinU | Eigen::ComputeThinV);
+            const V_type &sv = svd.singularValues();
+            int r = 0;
+            while (r < p && sv[r] > l) {
+                r++;
+            }
+            if (r == p) {
+                // 探索次元が足りない
+                k *= 2;
+                continue;
+            }
+
+            const V_type softenSV = (sv.head(r).array() - l).matrix();
+            nu   = softenSV.sum();
+            rank = r + 1;
+            _V   = svd.matrixV().leftCols(std::max(r, 1));
+
+            return (Q*svd.matrixU().leftCols(r))*softenSV.asDiagonal()*svd.matrixV().leftCols(r).transpose();
+        }
+    }
+
+private:
+    static M_type orthonormalize(const M_type &Y)
+    {
+        Eigen::HouseholderQR <M_type> qr(Y);
+
+        return qr.householderQ()*M_type::Identity(Y.rows(), Y.cols());
+    }
+
+    M_type full(const M_type &M, const Scalar &l, Scalar &nu)
+    {
+        Eigen::JacobiSVD <M_type> svd(M, Eigen::ComputeThinU | Eigen::ComputeThinV);
+        V_type softenSV = (svd.singularValues().array() - l).max(static_cast <Scalar>(0)).matrix();
+        nu = softenSV.sum();
+        int r = 0;
+        while (r < softenSV.size() && softenSV[r] > 0) {
+            r++;
+        }
+        rank = r + 1;
+        _V   = svd.matrixV().leftCols(std::max(r, 1));
+
+        return svd.matrixU()*softenSV.asDiagonal()*svd.matrixV().transpose();
+    }
+};
+
+#endif
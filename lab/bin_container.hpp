@@ -0,0 +1,106 @@
+/*! @file
+    @brief mmapして読むバイナリ形式に共通の入れ物．
+    [ヘッダ64バイト][セクション]...の順で，各セクションは64バイト境界まで詰め物をする．
+    ヘッダの中身は形式ごとに決め，ここでは大きさと読み書きだけを扱う
+    @author templateaholic10
+*/
+
+#ifndef BIN_CONTAINER_HPP
+#define BIN_CONTAINER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include "mapped_file.hpp"
+
+namespace bin_container {
+    constexpr std::uint32_t byte_order = 0x01020304;
+    constexpr std::size_t   alignment  = 64;
+
+    /*! @brief bytesを64バイト境界まで切り上げた大きさ
+    */
+    inline std::size_t padded(const std::size_t bytes)
+    {
+        return (bytes + alignment - 1) / alignment * alignment;
+    }
+
+    /*! @brief ヘッダを書く
+        @tparam Header 各形式のヘッダ．ちょうど64バイトであること
+    */
+    template <typename Header>
+    void write_header(std::ostream &os, const Header &header)
+    {
+        static_assert(sizeof(Header) == alignment, "Header must fill one alignment unit");
+        os.write(reinterpret_cast <const char *>(&header), sizeof(header));
+    }
+
+    /*! @brief ヘッダを読む
+        @return 読めたか．読めなければfailbitが立つ
+    */
+    template <typename Header>
+    bool read_header(std::istream &is, Header &header)
+    {
+        static_assert(sizeof(Header) == alignment, "Header must fill one alignment unit");
+
+        return static_cast <bool>(is.read(reinterpret_cast <char *>(&header), sizeof(header)));
+    }
+
+    /*! @brief ファイルのoffsetにあるヘッダを読む
+        @return offsetが64バイト境界に揃っていないか，ファイルが短ければfalse
+    */
+    template <typename Header>
+    bool read_header(const Mapped_file &file, const std::size_t offset, Header &header)
+    {
+        static_assert(sizeof(Header) == alignment, "Header must fill one alignment unit");
+        if (offset % alignment != 0 || offset > file.size() || sizeof(header) > file.size() - offset) {
+            return false;
+        }
+        std::memcpy(&header, file.data() + offset, sizeof(header));
+
+        return true;
+    }
+
+    /*! @brief isの残りのバイト数
+        @return シークできないストリームでは-1
+    */
+    inline std::streamoff remaining(std::istream &is)
+    {
+        const std::streampos here = is.tellg();
+        if (here == std::streampos(-1) || !is.seekg(0, std::ios_base::end)) {
+            is.clear(is.rdstate() & ~std::ios_base::failbit);
+
+            return -1;
+        }
+        const std::streampos end = is.tellg();
+        is.seekg(here);
+
+        return end - here;
+    }
+
+    /*! @brief bytesバイトを書き，64バイト境界まで0で詰める
+    */
+    inline void write_section(std::ostream &os, const void *p, const std::size_t bytes)
+    {
+        static const char zeros[alignment] = {};
+        os.write(static_cast <const char *>(p), bytes);
+        os.write(zeros, padded(bytes) - bytes);
+    }
+
+    /*! @brief write_sectionで書いたものを読む
+        @return 詰め物まで読めたか．読めなければfailbitが立つ
+    */
+    inline bool read_section(std::istream &is, void *p, const std::size_t bytes)
+    {
+        const std::streamsize padding = padded(bytes) - bytes;
+        is.read(static_cast <char *>(p), bytes);
+        // ignoreはファイルの終わりでfailbitを立てないので数える
+        if (is.ignore(padding) && is.gcount() != padding) {
+            is.setstate(std::ios_base::failbit);
+        }
+
+        return static_cast <bool>(is);
+    }
+}
+
+#endif
@@ -0,0 +1,221 @@
+#ifndef BITVECTOR
+#define BITVECTOR
+
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "succinct_bin.hpp"
+#include "thread_pool.hpp"
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace bitvector {
+    // 64ビット語の1の数．
+    inline unsigned popcount(const std::uint64_t word)
+    {
+#if defined(__GNUC__)
+        return __builtin_popcountll(word);
+#else
+        std::uint64_t x = word - ((word >> 1) & 0x5555555555555555ULL);
+        x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+        x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+
+        return (x * 0x0101010101010101ULL) >> 56;
+#endif
+    }
+
+    // 64ビット語の下からorder番目（0-origin）の1の位置．order < popcount(word)であること．
+    // BMI2があればpdepで1命令．なければバイト単位で絞り込む．
+    inline unsigned select_in_word(const std::uint64_t word, unsigned order)
+    {
+#if defined(__BMI2__)
+        return __builtin_ctzll(_pdep_u64(std::uint64_t(1) << order, word));
+#else
+        unsigned shift = 0;
+        for (; ; shift += 8) {
+            const unsigned count = popcount((word >> shift) & 0xff);
+            if (order < count) {
+                break;
+            }
+            order -= count;
+        }
+        std::uint64_t byte = (word >> shift) & 0xff;
+        for (; order > 0; order--) {
+            byte &= byte - 1;
+        }
+#if defined(__GNUC__)
+        return shift + __builtin_ctzll(byte);
+#else
+        unsigned bit = 0;
+        for (; !((byte >> bit) & 1); bit++) {
+        }
+
+        return shift + bit;
+#endif
+#endif
+    }
+
+    // 実行時に長さを決める簡潔ビットベクトル
+    // 64バイトのキャッシュライン1本を，先頭の64ビットにそれより前の1の数，残り7語（448ビット）にビット列を入れた単位とする．
+    // rankはライン1本を読むだけで済む（キャッシュミス1回）．
+    // selectはselect_sample個おきの1（0）が入っているラインを覚えておき，その間を補間探索する．
+    // ビット列が偏っていなければほぼO(1)．
+    // 位置の数え方はUnionbitarrayと同じで，rank(a, index)は先頭index個のaの数，
+    // select(a, order)はorder番目のaの位置（1-origin）．
+    // succinct::binの形式で書き出し，mmapしたファイルからコピーせずに読める．
+    class Bitvector
+    {
+    public:
+        using position_t = std::uint64_t;
+        using time_t     = std::uint64_t;
+
+        static constexpr position_t line_words = 8;                     // 1ラインの語数
+        static constexpr position_t line_bits  = 64 * (line_words - 1); // 1ラインのビット数
+        // selectの標本間隔
+        static constexpr time_t select_sample = 4096;
+        // buildで1タスクが受け持つライン数
+        static constexpr position_t build_grain = 4096;
+
+    public:
+        Bitvector();
+        // 長さnの0のビット列．setしてからbuildする．
+        explicit Bitvector(const position_t n);
+        Bitvector(const std::vector <bool> &org_array);
+        // '0'と'1'の文字列
+        Bitvector(const std::string &org_array);
+        ~Bitvector();
+        Bitvector(const Bitvector &other);
+        Bitvector&operator=(const Bitvector &other);
+        // ムーブは確保せずにラインを移し，ムーブ元を長さ0のビット列にする．
+        Bitvector(Bitvector &&other) noexcept;
+        Bitvector&operator=(Bitvector &&other) noexcept;
+
+        // index番目（0-origin）のビットを書き換える．rank, selectを使う前にbuildし直す．
+        // ファイルに結びつけたビット列は書き換えられない．
+        void set(const position_t index, const bool bit = true);
+
+        // index番目（0-origin）から64ビットをまとめて書き換える．indexは64の倍数．
+        // 別々のラインへの書き込みは複数のスレッドから同時に行ってよい．
+        void set_word(const position_t index, const std::uint64_t word);
+
+        // ラインの先頭の1の数とselectの標本を作る．O(n / 64)時間．
+        // poolを渡すとbuild_grainライン単位で並列に作る．ファイルや長さ0のビット列では何もしない．
+        void build(parallel::Thread_pool *pool = nullptr);
+
+        // O(1)時間．
+        unsigned long access(const position_t index) const;
+
+        // ライン1本の読み込み．O(1)時間．
+        unsigned long rank(const unsigned long a, const position_t index) const;
+
+        // 標本の間の探索とpdepによる語内の選択．
+        unsigned long select(const unsigned long a, const time_t order) const;
+
+        // 0-originのindex番目のビット
+        bool operator[](const position_t index) const;
+
+        // rank(a, index)やaccessで読むラインを先読みする．
+        // 独立なクエリをまとめて処理するとき，次に読むラインのキャッシュミスを重ねて待つのに使う．
+        void prefetch(const position_t index) const;
+
+        // select(a, order)が最初に読む標本を先読みする．
+        void prefetch_select(const unsigned long a, const time_t order) const;
+
+        size_t        size() const;
+        // aの総数
+        size_t        count(const unsigned long a) const;
+        // 使っているバイト数
+        size_t        bytes() const;
+        std::string   to_string() const;
+        unsigned long invalid_value() const;
+        std::string   str() const;
+
+        friend std::ostream&operator<<(std::ostream &os, const Bitvector &bv);
+
+        // バイナリ形式で書く．osはバイナリモードで開くこと．
+        std::ostream &write(std::ostream &os) const;
+
+        // writeで書いたものをコピーして読む．形式が合わないか，標本が壊れているか，長さがストリームの残りに収まらなければ
+        // failbitを立てて長さ0にする．
+        std::istream &read(std::istream &is);
+
+        // fileのoffsetにあるビット列を，ラインも標本もコピーせずに指す．標本が壊れていればfalse
+        // ファイルはこのビット列とそのコピーが生きている間開いたままになる．
+        bool attach(const std::shared_ptr <const Mapped_file> &file, const std::size_t offset = 0);
+
+        // ファイルをmmapして先頭のビット列を指す．
+        bool open(const std::string &filename);
+
+        // writeで書くバイト数（ヘッダ込み）．次のレコードの位置を求めるのに使う．
+        size_t        binary_size() const;
+
+    private:
+        // 長さnの0のラインを確保する．確保できなければstd::bad_allocを投げ，元のまま残す．
+        void          allocate(const position_t n);
+
+        // 長さ0のビット列が共有するライン1本と標本．確保せずに有効な状態を作るのに使う．
+        static std::uint64_t    *empty_lines();
+        static const position_t *empty_hints();
+
+        // _linesを自分で確保したか
+        bool          owns_lines() const;
+
+        // 自分で確保したラインを解放する．
+        void          release() noexcept;
+
+        // 確保せずに長さ0のビット列にする．
+        void          make_empty() noexcept;
+
+        // 構造が同じか確かめるための値
+        static std::uint64_t layout();
+
+        // 1（0）がcount個のときの標本の数（番兵込み）
+        static size_t hint_num(const time_t count);
+
+        // _hintsの中を指し直す．
+        void          bind_hints();
+
+        // num個の標本がどれもline_num本のラインを指し，減らずに番兵（最後のライン）で終わるか．
+        // 壊れたファイルを読んだときにselectがラインの外を読まないように確かめる．
+        static bool   valid_hints(const position_t *hints, const size_t num, const position_t line_num);
+
+        time_t        rank1(const position_t index) const;
+
+        position_t    select1(const time_t order) const;
+
+        position_t    select0(const time_t order) const;
+
+        // ラインlineより前の0の数
+        time_t        line_rank0(const position_t line) const;
+
+        // [lower, upper]でline_rank(line) < orderとなる最後のラインを探す．
+        template <class Rank>
+        position_t    search_line(position_t lower, position_t upper, const time_t order, Rank &&line_rank) const;
+
+    private:
+        position_t _length;
+        position_t _line_num;
+        time_t     _ones;
+        // キャッシュラインに揃えた_line_num本のライン．最後のラインの長さを超える部分は0．
+        // ファイルのページかempty_lines()を指すこともある．
+        std::uint64_t *_lines;
+        // k * select_sample + 1番目の1（0）が入っているライン．末尾に最後のラインを置く．
+        // 自分で作った標本は_hintsに1の分，0の分の順に続けて持つ．
+        std::vector <position_t> _hints;
+        const position_t        *_select1_hint;
+        const position_t        *_select0_hint;
+        // nullptrでなければ_linesと標本はこのファイルのページを指す．
+        std::shared_ptr <const Mapped_file> _file;
+    };
+
+    void testBitvector();
+}
+
+#include "detail/bitvector.hpp"
+
+#endif
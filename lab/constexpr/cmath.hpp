@@ -4,6 +4,8 @@
 #ifndef CONSTEXPR_CMATH_HPP
 #define CONSTEXPR_CMATH_HPP
 
+#include <type_traits>
+
 #ifndef CMATH_EPSILON
 #define CMATH_EPSILON 1e-6
 #endif
@@ -164,6 +166,108 @@ namespace cpstd {
     {
         return static_cast<Result>(sqrt(d));
     }
+
+    /*! @brief 三角関数を計算する型．浮動小数点数型はその型，整数型はdouble
+    */
+    template <typename Numeric>
+    using floating_t = typename std::conditional <std::is_floating_point <Numeric>::value, Numeric, double>::type;
+
+    /*! @brief 円周率
+    */
+    constexpr double pi = 3.14159265358979323846;
+
+    /*! @brief 型Realの精度の円周率
+    */
+    template <typename Real>
+    constexpr Real pi_v = static_cast<Real>(3.141592653589793238462643383279502884L);
+
+    /*! @brief [-pi, pi]に帰着させる
+    */
+    template <typename Real>
+    constexpr Real reduce_angle(const Real d)
+    {
+        Real x = d;
+        while (x > pi_v<Real>) {
+            x -= 2 * pi_v<Real>;
+        }
+        while (x < -pi_v<Real>) {
+            x += 2 * pi_v<Real>;
+        }
+
+        return x;
+    }
+
+    /*! @brief |x| <= pi / 2でのsinのTaylor展開．項が消えるまで足す
+    */
+    template <typename Real>
+    constexpr Real sin_series(const Real x)
+    {
+        Real sum  = x;
+        Real term = x;
+        for (int k = 1; k < CMATH_MAX_REP; k++) {
+            term *= -x * x / ((2 * k) * (2 * k + 1));
+            if (sum + term == sum) {
+                break;
+            }
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    /*! @brief |x| <= pi / 2でのcosのTaylor展開
+    */
+    template <typename Real>
+    constexpr Real cos_series(const Real x)
+    {
+        Real sum  = 1;
+        Real term = 1;
+        for (int k = 1; k < CMATH_MAX_REP; k++) {
+            term *= -x * x / ((2 * k - 1) * (2 * k));
+            if (sum + term == sum) {
+                break;
+            }
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    /*! @brief コンパイル時正弦関数．Taylor展開による実装
+        @param d 実数（ラジアン）
+        @return dの正弦．dが浮動小数点数ならその型で，整数ならdoubleで計算する
+    */
+    template <typename Numeric>
+    constexpr floating_t<Numeric> sin(const Numeric d)
+    {
+        using Real = floating_t<Numeric>;
+        const Real x = reduce_angle<Real>(d);
+        if (x > pi_v<Real> / 2) {
+            return sin_series(pi_v<Real> - x);
+        } else if (x < -pi_v<Real> / 2) {
+            return sin_series(-pi_v<Real> - x);
+        }
+
+        return sin_series(x);
+    }
+
+    /*! @brief コンパイル時余弦関数．Taylor展開による実装
+        @param d 実数（ラジアン）
+        @return dの余弦．dが浮動小数点数ならその型で，整数ならdoubleで計算する
+    */
+    template <typename Numeric>
+    constexpr floating_t<Numeric> cos(const Numeric d)
+    {
+        using Real = floating_t<Numeric>;
+        const Real x = reduce_angle<Real>(d);
+        if (x > pi_v<Real> / 2) {
+            return -cos_series(pi_v<Real> - x);
+        } else if (x < -pi_v<Real> / 2) {
+            return -cos_series(-pi_v<Real> - x);
+        }
+
+        return cos_series(x);
+    }
 }
 
 #endif
@@ -1,11 +1,12 @@
 ﻿/*! @file
-    @brief DCT（離散コサイン変換）．DCT-1とDCT-2がある
+    @brief DCT（離散コサイン変換）．DCT-1からDCT-4がある
     @author templateaholic10
     @date 12/29
 */
 #ifndef DCT_HPP
 #define DCT_HPP
 
+#include <cmath>
 #include <fft>
 #include <elemwise>
 
@@ -164,6 +165,319 @@ namespace Eigen {
         return retval;
     }
 
+    /*! @brief DCTの型
+    */
+    enum class DCT_TYPE { I, II, III, IV };
+
+    /*! @class
+        @brief 長さNの実数→実数のDCTの計画
+        @tparam Scalar 実数型
+        @tparam Type DCTの型
+        @tparam Direction FORWARDで順変換，INVERSEで逆変換
+        偶拡張せず，Makhoulの並べ替えで長さN程度の実FFTに帰着させる．
+        スケーリングはevenize→fft→deevenizeの0.5倍，逆変換は2倍の規約に合わせる．
+        - DCT-1  : X_k = (x_0 + (-1)^k x_{N-1}) / 2 + sum_{n=1}^{N-2} x_n cos(pi k n / (N-1))．逆変換は2/(N-1)倍のDCT-1
+        - DCT-2  : X_k = sum_n x_n cos(pi k (2n+1) / 2N)．逆変換は2/N倍のDCT-3
+        - DCT-3  : X_k = x_0 / 2 + sum_{n=1}^{N-1} x_n cos(pi n (2k+1) / 2N)．逆変換は2/N倍のDCT-2
+        - DCT-4  : X_k = sum_n x_n cos(pi (2n+1) (2k+1) / 4N)．逆変換は2/N倍のDCT-4
+        複素系列は実部と虚部を別々に変換する．
+        作業領域を持つのでスレッド間で共有しない．スレッドごとの計画はdct_planで得る
+    */
+    template <typename Scalar, DCT_TYPE Type, FFT_DIRECTION Direction>
+    class DCT_plan {
+    public:
+        using complex_type = std::complex <Scalar>;
+    private:
+        // 逆変換で実際に使う核の型
+        static constexpr DCT_TYPE kernel_type = (Direction == FFT_DIRECTION::FORWARD) ? Type
+                                                : (Type == DCT_TYPE::II) ? DCT_TYPE::III
+                                                : (Type == DCT_TYPE::III) ? DCT_TYPE::II
+                                                : Type;
+
+        const size_t                _n;
+        Scalar                      _scale;
+        Eigen::FFT <Scalar>         _fft;      // 実FFTは半スペクトル，スケーリングなし
+        std::vector <Scalar>        _x;        // 入力の実部
+        std::vector <Scalar>        _xi;       // 入力の虚部
+        std::vector <Scalar>        _re;       // 結果の実部
+        std::vector <Scalar>        _im;       // 結果の虚部
+        std::vector <Scalar>        _v;        // 並べ替えた系列
+        std::vector <complex_type> _z;        // スペクトル
+        std::vector <complex_type> _zt;
+        std::vector <complex_type> _twiddle;  // 前処理の回転因子
+        std::vector <complex_type> _twiddle2; // 後処理の回転因子
+        std::vector <Scalar>        _sin;
+        bool                        _complex;  // 直前の入力が複素数か
+    public:
+        /*! @param n 系列の長さ．DCT-1では2以上
+        */
+        explicit DCT_plan(const size_t n)
+            : _n(n), _scale(1.), _x(n), _xi(n), _re(n), _im(n), _complex(false)
+        {
+            _fft.SetFlag(Eigen::FFT <Scalar>::HalfSpectrum);
+            _fft.SetFlag(Eigen::FFT <Scalar>::Unscaled);
+            const Scalar pi = M_PI;
+            switch (kernel_type) {
+                case DCT_TYPE::I:
+                {
+                    const size_t M = n - 1;
+                    if (M % 2 == 0) {
+                        // 長さN-1の実FFT
+                        _v.resize(M);
+                        _z.resize(M / 2 + 1);
+                        _sin.resize(M);
+                        for (size_t j = 0; j < M; j++) {
+                            _sin[j] = std::sin(pi * j / M);
+                        }
+                    } else {
+                        // 偶拡張した長さ2N-2の実FFT
+                        _v.resize(2 * M);
+                        _z.resize(M + 1);
+                    }
+                    break;
+                }
+                case DCT_TYPE::II:
+                case DCT_TYPE::III:
+                    _v.resize(n);
+                    _z.resize(n / 2 + 1);
+                    _twiddle.resize(n / 2 + 1);
+                    for (size_t k = 0; k <= n / 2; k++) {
+                        _twiddle[k] = std::polar(Scalar(1.), -pi * k / (2 * n));
+                    }
+                    break;
+                case DCT_TYPE::IV:
+                    if (n % 2 == 0) {
+                        // 長さN/2の複素FFT
+                        _z.resize(n / 2);
+                        _zt.resize(n / 2);
+                        _twiddle.resize(n / 2);
+                        _twiddle2.resize(n / 2);
+                        for (size_t j = 0; j < n / 2; j++) {
+                            _twiddle[j]  = std::polar(Scalar(1.), -pi * (4 * j + 1) / (4 * n));
+                            _twiddle2[j] = std::polar(Scalar(1.), -pi * j / n);
+                        }
+                    } else {
+                        // 0詰めした長さ2Nの複素FFT
+                        _z.resize(2 * n);
+                        _zt.resize(2 * n);
+                        _twiddle.resize(n);
+                        _twiddle2.resize(n);
+                        for (size_t j = 0; j < n; j++) {
+                            _twiddle[j]  = std::polar(Scalar(1.), -pi * j / (2 * n));
+                            _twiddle2[j] = std::polar(Scalar(1.), -pi * (2 * j + 1) / (4 * n));
+                        }
+                    }
+                    break;
+            }
+            if (Direction == FFT_DIRECTION::INVERSE) {
+                _scale = (Type == DCT_TYPE::I) ? Scalar(2.) / (n - 1) : Scalar(2.) / n;
+            }
+        }
+
+        DCT_plan(const DCT_plan&)           = delete;
+        DCT_plan&operator=(const DCT_plan&) = delete;
+
+        size_t size() const
+        {
+            return _n;
+        }
+
+        /*! @brief 長さsize()の系列inを変換してoutに書く．outはinと重なってもよい
+            @tparam From 実数型または複素数型
+            @tparam To 実数型または複素数型．実数型のときは結果の実部を書く
+        */
+        template <typename From, typename To>
+        void execute(const From *in, To *out)
+        {
+            load(in);
+            kernel(_x.data(), _re.data());
+            if (_complex && std::is_complex <To>::value) {
+                kernel(_xi.data(), _im.data());
+            }
+            store(out);
+        }
+
+    private:
+        void load(const Scalar *in)
+        {
+            std::copy(in, in + _n, _x.begin());
+            _complex = false;
+        }
+
+        void load(const complex_type *in)
+        {
+            for (size_t i = 0; i < _n; i++) {
+                _x[i]  = std::real(in[i]);
+                _xi[i] = std::imag(in[i]);
+            }
+            _complex = true;
+        }
+
+        void store(Scalar *out) const
+        {
+            for (size_t i = 0; i < _n; i++) {
+                out[i] = _re[i] * _scale;
+            }
+        }
+
+        void store(complex_type *out) const
+        {
+            for (size_t i = 0; i < _n; i++) {
+                out[i] = complex_type(_re[i] * _scale, _complex ? _im[i] * _scale : Scalar(0.));
+            }
+        }
+
+        void kernel(const Scalar *x, Scalar *y)
+        {
+            // Eigen::FFTは長さ1を扱えないので直接求める
+            if (_n == 1 && kernel_type != DCT_TYPE::I) {
+                y[0] = (kernel_type == DCT_TYPE::II) ? x[0]
+                       : (kernel_type == DCT_TYPE::III) ? Scalar(0.5) * x[0]
+                       : x[0] * std::cos(Scalar(M_PI / 4.));
+
+                return;
+            }
+            switch (kernel_type) {
+                case DCT_TYPE::I:
+                    kernel1(x, y);
+                    break;
+                case DCT_TYPE::II:
+                    kernel2(x, y);
+                    break;
+                case DCT_TYPE::III:
+                    kernel3(x, y);
+                    break;
+                case DCT_TYPE::IV:
+                    kernel4(x, y);
+                    break;
+            }
+        }
+
+        // DCT-1
+        void kernel1(const Scalar *x, Scalar *y)
+        {
+            const size_t M = _n - 1;
+            if (M % 2 != 0) {
+                // abcdeからabcdedcbを作って実FFT
+                std::copy(x, x + _n, _v.begin());
+                std::reverse_copy(x + 1, x + M, _v.begin() + _n);
+                _fft.fwd(_z.data(), _v.data(), 2 * M);
+                for (size_t k = 0; k < _n; k++) {
+                    y[k] = Scalar(0.5) * _z[k].real();
+                }
+
+                return;
+            }
+            // y_j = (x_j + x_{M-j}) / 2 - sin(pi j / M) (x_j - x_{M-j}) の実FFTの実部が偶数番目，
+            // 虚部の累積和が奇数番目になる
+            Scalar odd = Scalar(0.5) * (x[0] - x[M]);
+            _v[0] = Scalar(0.5) * (x[0] + x[M]);
+            for (size_t j = 1; j < M; j++) {
+                _v[j] = Scalar(0.5) * (x[j] + x[M - j]) - _sin[j] * (x[j] - x[M - j]);
+            }
+            for (size_t j = 1; j < M / 2; j++) {
+                odd += _sin[M / 2 - j] * (x[j] - x[M - j]); // cos(pi j / M)
+            }
+            _fft.fwd(_z.data(), _v.data(), M);
+            y[0] = _z[0].real();
+            y[1] = odd;
+            for (size_t k = 1; k <= M / 2; k++) {
+                y[2 * k] = _z[k].real();
+                if (2 * k + 1 < _n) {
+                    odd         -= _z[k].imag();
+                    y[2 * k + 1] = odd;
+                }
+            }
+        }
+
+        // DCT-2．偶数番目を前から，奇数番目を後ろから並べた系列の実FFTに回転因子を掛ける
+        void kernel2(const Scalar *x, Scalar *y)
+        {
+            for (size_t k = 0; 2 * k < _n; k++) {
+                _v[k] = x[2 * k];
+            }
+            for (size_t k = 0; 2 * k + 1 < _n; k++) {
+                _v[_n - 1 - k] = x[2 * k + 1];
+            }
+            _fft.fwd(_z.data(), _v.data(), _n);
+            for (size_t k = 0; k <= _n / 2; k++) {
+                const complex_type c = _twiddle[k] * _z[k];
+                y[k] = c.real();
+                if (k > 0 && _n - k != k) {
+                    y[_n - k] = -c.imag();
+                }
+            }
+        }
+
+        // DCT-3．kernel2の逆をたどる
+        void kernel3(const Scalar *x, Scalar *y)
+        {
+            _z[0] = complex_type(x[0], 0.);
+            for (size_t k = 1; k <= _n / 2; k++) {
+                _z[k] = std::conj(_twiddle[k]) * complex_type(x[k], -x[_n - k]);
+            }
+            _fft.inv(_v.data(), _z.data(), _n);
+            for (size_t k = 0; 2 * k < _n; k++) {
+                y[2 * k] = Scalar(0.5) * _v[k];
+            }
+            for (size_t k = 0; 2 * k + 1 < _n; k++) {
+                y[2 * k + 1] = Scalar(0.5) * _v[_n - 1 - k];
+            }
+        }
+
+        // DCT-4
+        void kernel4(const Scalar *x, Scalar *y)
+        {
+            if (_n % 2 == 0) {
+                // (x_{2j} + i x_{N-1-2j})に回転因子を掛けて長さN/2の複素FFT
+                const size_t m = _n / 2;
+                for (size_t j = 0; j < m; j++) {
+                    _z[j] = _twiddle[j] * complex_type(x[2 * j], x[_n - 1 - 2 * j]);
+                }
+                if (m == 1) {
+                    _zt[0] = _z[0];
+                } else {
+                    _fft.fwd(_zt.data(), _z.data(), m);
+                }
+                for (size_t k = 0; k < m; k++) {
+                    const complex_type c = _twiddle2[k] * _zt[k];
+                    y[2 * k]          = c.real();
+                    y[_n - 1 - 2 * k] = -c.imag();
+                }
+
+                return;
+            }
+            for (size_t j = 0; j < _n; j++) {
+                _z[j] = _twiddle[j] * x[j];
+            }
+            std::fill(_z.begin() + _n, _z.end(), complex_type(0., 0.));
+            _fft.fwd(_zt.data(), _z.data(), 2 * _n);
+            for (size_t k = 0; k < _n; k++) {
+                y[k] = (_twiddle2[k] * _zt[k]).real();
+            }
+        }
+    };
+
+    /*! @brief (n, Scalar, Type, Direction)のDCTの計画
+    */
+    template <typename Scalar, DCT_TYPE Type, FFT_DIRECTION Direction>
+    DCT_plan <Scalar, Type, Direction>&dct_plan(const size_t n)
+    {
+        return cached_plan <DCT_plan <Scalar, Type, Direction> >(n);
+    }
+
+    /*! @brief 多変量時系列の全系列をbatch_transformでまとめてDCTする
+        @tparam Option 時間方向の縦横．Eigen::ColMajorのとき時間方向は縦
+    */
+    template <DCT_TYPE Type, FFT_DIRECTION Direction, typename To, int Option, typename From, int Rows, int Cols>
+    Eigen::Matrix <To, Rows, Cols> dct_series(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads)
+    {
+        Eigen::Matrix <To, Rows, Cols> retval(X.rows(), X.cols());
+        batch_transform(dct_plan <typename std::decomplexify <To>::type, Type, Direction>, X, retval, Option, threads);
+
+        return retval;
+    }
+
     /*! @brief 1変量時系列のDCT-1
         @tparam To 実数型または複素数型．指定しないと実数型になる
         @tparam From 実数型または複素数型
@@ -179,7 +493,10 @@ namespace Eigen {
     template <typename To, typename From, size_t N>
     std::array <To, N> dct1(const std::array <From, N> &x)
     {
-        return (std::Elemwise <std::array <To, N> >(deevenize1(fft <To>(evenize1(x)))) * 0.5).array();
+        std::array <To, N> retval;
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::I, FFT_DIRECTION::FORWARD>(N).execute(x.data(), retval.data());
+
+        return retval;
     }
 
     /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため
@@ -190,6 +507,14 @@ namespace Eigen {
         return dct1 <typename std::decomplexify <From>::type>(x);
     }
 
+    /*! @brief 出力先を指定する場合．確保をしない
+    */
+    template <typename To, typename From, size_t N>
+    void dct1(const std::array <From, N> &x, std::array <To, N> &X)
+    {
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::I, FFT_DIRECTION::FORWARD>(N).execute(x.data(), X.data());
+    }
+
     /*! @brief std::vector用
     */
 
@@ -198,25 +523,38 @@ namespace Eigen {
     template <typename To, typename From>
     std::vector <To> dct1(const std::vector <From> &x)
     {
-        return (std::Elemwise <std::vector <To> >(deevenize1(fft <To>(evenize1(x)))) * 0.5).vector();
+        std::vector <To> retval(x.size());
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::I, FFT_DIRECTION::FORWARD>(x.size()).execute(x.data(), retval.data());
+
+        return retval;
     }
 
-    /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため
+    /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため．
+        先頭の非型引数は，型指定した呼び出しがこちらにも当たって曖昧にならないようにするため（std::array用のNと同じ）
     */
-    template <typename From>
+    template <int = 0, typename From>
     std::vector <typename std::decomplexify <From>::type> dct1(const std::vector <From> &x)
     {
-        return dct1 <typename std::decomplexify <From>::type>(x);
+        return dct1 <typename std::decomplexify <From>::type, From>(x);
+    }
+
+    /*! @brief 出力先を指定する場合．Xの大きさが合っていれば確保をしない
+    */
+    template <typename To, typename From>
+    void dct1(const std::vector <From> &x, std::vector <To> &X)
+    {
+        X.resize(x.size());
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::I, FFT_DIRECTION::FORWARD>(x.size()).execute(x.data(), X.data());
     }
 
     /*! @brief 多変量時系列のDCT-1
-        @tparam To 実数型または複素数型
-        指定しないと複素数型になる
+        @tparam To 実数型または複素数型．指定しないと実数型になる
+        @tparam Option 時間方向の縦横．デフォルト値はEigen::ColMajorでこのとき時間方向は縦
         @tparam From 実数型または複素数型
         @tparam Rows 行数
         @tparam Cols 列数
         @param X データ行列
-        @param option 時間方向の縦横．デフォルト値はEigen::ColMajorでこのとき時間方向は縦
+        @param threads スレッド数．系列を分担する
     */
 
     /*! @brief Eigen::Matrix用
@@ -225,33 +563,33 @@ namespace Eigen {
     /*! @brief 型指定する，方向指定する場合
     */
     template <typename To, int Option, typename From, int Rows, int Cols>
-    Eigen::Matrix <To, Rows, Cols> dct1(const Eigen::Matrix <From, Rows, Cols> &X)
+    Eigen::Matrix <To, Rows, Cols> dct1(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
     {
-        return deevenize1 <Option>(fft <To>(evenize1 <Option>(X), Option)) * 0.5;
+        return dct_series <DCT_TYPE::I, FFT_DIRECTION::FORWARD, To, Option>(X, threads);
     }
 
     /*! @brief 型指定する，方向指定しない場合を担保
     */
     template <typename To, int Rows, int Cols, typename From>
-    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> dct1(const Eigen::Matrix <From, Rows, Cols> &X)
+    Eigen::Matrix <To, Rows, Cols> dct1(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
     {
-        return dct1 <To, Eigen::ColMajor>(X);
+        return dct1 <To, Eigen::ColMajor>(X, threads);
     }
 
     /*! @brief 型指定しない，方向指定する場合を担保
     */
     template <int Option, int Rows, int Cols, typename From>
-    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> dct1(const Eigen::Matrix <From, Rows, Cols> &X)
+    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> dct1(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
     {
-        return dct1 <typename std::decomplexify <From>::type, Option>(X);
+        return dct1 <typename std::decomplexify <From>::type, Option>(X, threads);
     }
 
     /*! @brief 型指定しない，方向指定しない場合を担保
     */
     template <int Rows, int Cols, typename From>
-    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> dct1(const Eigen::Matrix <From, Rows, Cols> &X)
+    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> dct1(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
     {
-        return dct1 <typename std::decomplexify <From>::type, Eigen::ColMajor>(X);
+        return dct1 <typename std::decomplexify <From>::type, Eigen::ColMajor>(X, threads);
     }
 
     /*! @brief 1変量時系列のiDCT-1
@@ -269,7 +607,10 @@ namespace Eigen {
     template <typename To, typename From, size_t N>
     std::array <To, N> idct1(const std::array <From, N> &x)
     {
-        return (std::Elemwise <std::array <To, N> >(deevenize1(ifft <To>(evenize1(x)))) * 2.).array();
+        std::array <To, N> retval;
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::I, FFT_DIRECTION::INVERSE>(N).execute(x.data(), retval.data());
+
+        return retval;
     }
 
     /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため
@@ -280,6 +621,14 @@ namespace Eigen {
         return idct1 <typename std::decomplexify <From>::type>(x);
     }
 
+    /*! @brief 出力先を指定する場合．確保をしない
+    */
+    template <typename To, typename From, size_t N>
+    void idct1(const std::array <From, N> &x, std::array <To, N> &X)
+    {
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::I, FFT_DIRECTION::INVERSE>(N).execute(x.data(), X.data());
+    }
+
     /*! @brief std::vector用
     */
 
@@ -288,25 +637,38 @@ namespace Eigen {
     template <typename To, typename From>
     std::vector <To> idct1(const std::vector <From> &x)
     {
-        return (std::Elemwise <std::vector <To> >(deevenize1(ifft <To>(evenize1(x)))) * 2.).vector();
+        std::vector <To> retval(x.size());
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::I, FFT_DIRECTION::INVERSE>(x.size()).execute(x.data(), retval.data());
+
+        return retval;
     }
 
-    /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため
+    /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため．
+        先頭の非型引数は，型指定した呼び出しがこちらにも当たって曖昧にならないようにするため（std::array用のNと同じ）
     */
-    template <typename From>
+    template <int = 0, typename From>
     std::vector <typename std::decomplexify <From>::type> idct1(const std::vector <From> &x)
     {
-        return idct1 <typename std::decomplexify <From>::type>(x);
+        return idct1 <typename std::decomplexify <From>::type, From>(x);
     }
 
-    /*! @brief 多変量時系列のDCT-1
-        @tparam To 実数型または複素数型
-        指定しないと複素数型になる
+    /*! @brief 出力先を指定する場合．Xの大きさが合っていれば確保をしない
+    */
+    template <typename To, typename From>
+    void idct1(const std::vector <From> &x, std::vector <To> &X)
+    {
+        X.resize(x.size());
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::I, FFT_DIRECTION::INVERSE>(x.size()).execute(x.data(), X.data());
+    }
+
+    /*! @brief 多変量時系列のiDCT-1
+        @tparam To 実数型または複素数型．指定しないと実数型になる
+        @tparam Option 時間方向の縦横．デフォルト値はEigen::ColMajorでこのとき時間方向は縦
         @tparam From 実数型または複素数型
         @tparam Rows 行数
         @tparam Cols 列数
         @param X データ行列
-        @param option 時間方向の縦横．デフォルト値はEigen::ColMajorでこのとき時間方向は縦
+        @param threads スレッド数．系列を分担する
     */
 
     /*! @brief Eigen::Matrix用
@@ -315,33 +677,33 @@ namespace Eigen {
     /*! @brief 型指定する，方向指定する場合
     */
     template <typename To, int Option, typename From, int Rows, int Cols>
-    Eigen::Matrix <To, Rows, Cols> idct1(const Eigen::Matrix <From, Rows, Cols> &X)
+    Eigen::Matrix <To, Rows, Cols> idct1(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
     {
-        return deevenize1 <Option>(ifft <To>(evenize1 <Option>(X), Option)) * 2.;
+        return dct_series <DCT_TYPE::I, FFT_DIRECTION::INVERSE, To, Option>(X, threads);
     }
 
     /*! @brief 型指定する，方向指定しない場合を担保
     */
     template <typename To, int Rows, int Cols, typename From>
-    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> idct1(const Eigen::Matrix <From, Rows, Cols> &X)
+    Eigen::Matrix <To, Rows, Cols> idct1(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
     {
-        return idct1 <To, Eigen::ColMajor>(X);
+        return idct1 <To, Eigen::ColMajor>(X, threads);
     }
 
     /*! @brief 型指定しない，方向指定する場合を担保
     */
     template <int Option, int Rows, int Cols, typename From>
-    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> idct1(const Eigen::Matrix <From, Rows, Cols> &X)
+    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> idct1(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
     {
-        return idct1 <typename std::decomplexify <From>::type, Option>(X);
+        return idct1 <typename std::decomplexify <From>::type, Option>(X, threads);
     }
 
     /*! @brief 型指定しない，方向指定しない場合を担保
     */
     template <int Rows, int Cols, typename From>
-    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> idct1(const Eigen::Matrix <From, Rows, Cols> &X)
+    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> idct1(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
     {
-        return idct1 <typename std::decomplexify <From>::type, Eigen::ColMajor>(X);
+        return idct1 <typename std::decomplexify <From>::type, Eigen::ColMajor>(X, threads);
     }
 
     /*! @brief DCT-2用の偶拡張メタ関数．abcdeからabcdedcbを作る
@@ -681,10 +1043,10 @@ namespace Eigen {
     template <typename To, typename From, size_t N>
     std::array <To, N> dct2(const std::array <From, N> &x)
     {
-        _PRINTSEQ(evenize2(x))
-        _PRINTSEQ(fft <To>(evenize2(x)))
-        _PRINTSEQ(deevenize2(fft <To>(evenize2(x))))
-        return (std::Elemwise <std::array <To, N> >(deevenize2(fft <To>(evenize2(x)))) * 0.5).array();
+        std::array <To, N> retval;
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::II, FFT_DIRECTION::FORWARD>(N).execute(x.data(), retval.data());
+
+        return retval;
     }
 
     /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため
@@ -695,6 +1057,14 @@ namespace Eigen {
         return dct2 <typename std::decomplexify <From>::type>(x);
     }
 
+    /*! @brief 出力先を指定する場合．確保をしない
+    */
+    template <typename To, typename From, size_t N>
+    void dct2(const std::array <From, N> &x, std::array <To, N> &X)
+    {
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::II, FFT_DIRECTION::FORWARD>(N).execute(x.data(), X.data());
+    }
+
     /*! @brief std::vector用
     */
 
@@ -703,25 +1073,38 @@ namespace Eigen {
     template <typename To, typename From>
     std::vector <To> dct2(const std::vector <From> &x)
     {
-        return (std::Elemwise <std::vector <To> >(deevenize2(fft <To>(evenize2(x)))) * 0.5).vector();
+        std::vector <To> retval(x.size());
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::II, FFT_DIRECTION::FORWARD>(x.size()).execute(x.data(), retval.data());
+
+        return retval;
     }
 
-    /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため
+    /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため．
+        先頭の非型引数は，型指定した呼び出しがこちらにも当たって曖昧にならないようにするため（std::array用のNと同じ）
     */
-    template <typename From>
+    template <int = 0, typename From>
     std::vector <typename std::decomplexify <From>::type> dct2(const std::vector <From> &x)
     {
-        return dct2 <typename std::decomplexify <From>::type>(x);
+        return dct2 <typename std::decomplexify <From>::type, From>(x);
+    }
+
+    /*! @brief 出力先を指定する場合．Xの大きさが合っていれば確保をしない
+    */
+    template <typename To, typename From>
+    void dct2(const std::vector <From> &x, std::vector <To> &X)
+    {
+        X.resize(x.size());
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::II, FFT_DIRECTION::FORWARD>(x.size()).execute(x.data(), X.data());
     }
 
     /*! @brief 多変量時系列のDCT-2
-        @tparam To 実数型または複素数型
-        指定しないと複素数型になる
+        @tparam To 実数型または複素数型．指定しないと実数型になる
+        @tparam Option 時間方向の縦横．デフォルト値はEigen::ColMajorでこのとき時間方向は縦
         @tparam From 実数型または複素数型
         @tparam Rows 行数
         @tparam Cols 列数
         @param X データ行列
-        @param option 時間方向の縦横．デフォルト値はEigen::ColMajorでこのとき時間方向は縦
+        @param threads スレッド数．系列を分担する
     */
 
     /*! @brief Eigen::Matrix用
@@ -730,39 +1113,36 @@ namespace Eigen {
     /*! @brief 型指定する，方向指定する場合
     */
     template <typename To, int Option, typename From, int Rows, int Cols>
-    Eigen::Matrix <To, Rows, Cols> dct2(const Eigen::Matrix <From, Rows, Cols> &X)
+    Eigen::Matrix <To, Rows, Cols> dct2(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
     {
-        _PRINT(evenize2<Option>(X))
-        _PRINT(fft <To>(evenize2<Option>(X), Option))
-        _PRINT(deevenize2<Option>(fft <To>(evenize2<Option>(X), Option)))
-        return deevenize2 <Option>(fft <To>(evenize2 <Option>(X), Option)) * 0.5;
+        return dct_series <DCT_TYPE::II, FFT_DIRECTION::FORWARD, To, Option>(X, threads);
     }
 
     /*! @brief 型指定する，方向指定しない場合を担保
     */
     template <typename To, int Rows, int Cols, typename From>
-    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> dct2(const Eigen::Matrix <From, Rows, Cols> &X)
+    Eigen::Matrix <To, Rows, Cols> dct2(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
     {
-        return dct2 <To, Eigen::ColMajor>(X);
+        return dct2 <To, Eigen::ColMajor>(X, threads);
     }
 
     /*! @brief 型指定しない，方向指定する場合を担保
     */
     template <int Option, int Rows, int Cols, typename From>
-    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> dct2(const Eigen::Matrix <From, Rows, Cols> &X)
+    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> dct2(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
     {
-        return dct2 <typename std::decomplexify <From>::type, Option>(X);
+        return dct2 <typename std::decomplexify <From>::type, Option>(X, threads);
     }
 
     /*! @brief 型指定しない，方向指定しない場合を担保
     */
     template <int Rows, int Cols, typename From>
-    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> dct2(const Eigen::Matrix <From, Rows, Cols> &X)
+    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> dct2(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
     {
-        return dct2 <typename std::decomplexify <From>::type, Eigen::ColMajor>(X);
+        return dct2 <typename std::decomplexify <From>::type, Eigen::ColMajor>(X, threads);
     }
 
-    /*! @brief 1変量時系列のiDCT-2
+    /*! @brief 1変量時系列のiDCT-2（DCT-3の2/N倍）
         @tparam To 実数型または複素数型．指定しないと実数型になる
         @tparam From 実数型または複素数型
         @tparam N 系列の長さ
@@ -777,10 +1157,10 @@ namespace Eigen {
     template <typename To, typename From, size_t N>
     std::array <To, N> idct2(const std::array <From, N> &x)
     {
-        _PRINTSEQ(ievenize2(x))
-        _PRINTSEQ(ifft <To>(ievenize2(x)))
-        _PRINTSEQ(ideevenize2(ifft <To>(ievenize2(x))))
-        return (std::Elemwise <std::array <To, N> >(ideevenize2(ifft <To>(ievenize2(x)))) * 2.).array();
+        std::array <To, N> retval;
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::II, FFT_DIRECTION::INVERSE>(N).execute(x.data(), retval.data());
+
+        return retval;
     }
 
     /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため
@@ -791,6 +1171,14 @@ namespace Eigen {
         return idct2 <typename std::decomplexify <From>::type>(x);
     }
 
+    /*! @brief 出力先を指定する場合．確保をしない
+    */
+    template <typename To, typename From, size_t N>
+    void idct2(const std::array <From, N> &x, std::array <To, N> &X)
+    {
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::II, FFT_DIRECTION::INVERSE>(N).execute(x.data(), X.data());
+    }
+
     /*! @brief std::vector用
     */
 
@@ -799,25 +1187,494 @@ namespace Eigen {
     template <typename To, typename From>
     std::vector <To> idct2(const std::vector <From> &x)
     {
-        return (std::Elemwise <std::vector <To> >(deevenize2(ifft <To>(evenize2(x)))) * 2.).vector();
+        std::vector <To> retval(x.size());
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::II, FFT_DIRECTION::INVERSE>(x.size()).execute(x.data(), retval.data());
+
+        return retval;
     }
 
-    /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため
+    /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため．
+        先頭の非型引数は，型指定した呼び出しがこちらにも当たって曖昧にならないようにするため（std::array用のNと同じ）
     */
-    template <typename From>
+    template <int = 0, typename From>
     std::vector <typename std::decomplexify <From>::type> idct2(const std::vector <From> &x)
     {
-        return idct2 <typename std::decomplexify <From>::type>(x);
+        return idct2 <typename std::decomplexify <From>::type, From>(x);
     }
 
-    /*! @brief 多変量時系列のDCT-2
-        @tparam To 実数型または複素数型
-        指定しないと複素数型になる
+    /*! @brief 出力先を指定する場合．Xの大きさが合っていれば確保をしない
+    */
+    template <typename To, typename From>
+    void idct2(const std::vector <From> &x, std::vector <To> &X)
+    {
+        X.resize(x.size());
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::II, FFT_DIRECTION::INVERSE>(x.size()).execute(x.data(), X.data());
+    }
+
+    /*! @brief 多変量時系列のiDCT-2（DCT-3の2/N倍）
+        @tparam To 実数型または複素数型．指定しないと実数型になる
+        @tparam Option 時間方向の縦横．デフォルト値はEigen::ColMajorでこのとき時間方向は縦
+        @tparam From 実数型または複素数型
+        @tparam Rows 行数
+        @tparam Cols 列数
+        @param X データ行列
+        @param threads スレッド数．系列を分担する
+    */
+
+    /*! @brief Eigen::Matrix用
+    */
+
+    /*! @brief 型指定する，方向指定する場合
+    */
+    template <typename To, int Option, typename From, int Rows, int Cols>
+    Eigen::Matrix <To, Rows, Cols> idct2(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
+    {
+        return dct_series <DCT_TYPE::II, FFT_DIRECTION::INVERSE, To, Option>(X, threads);
+    }
+
+    /*! @brief 型指定する，方向指定しない場合を担保
+    */
+    template <typename To, int Rows, int Cols, typename From>
+    Eigen::Matrix <To, Rows, Cols> idct2(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
+    {
+        return idct2 <To, Eigen::ColMajor>(X, threads);
+    }
+
+    /*! @brief 型指定しない，方向指定する場合を担保
+    */
+    template <int Option, int Rows, int Cols, typename From>
+    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> idct2(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
+    {
+        return idct2 <typename std::decomplexify <From>::type, Option>(X, threads);
+    }
+
+    /*! @brief 型指定しない，方向指定しない場合を担保
+    */
+    template <int Rows, int Cols, typename From>
+    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> idct2(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
+    {
+        return idct2 <typename std::decomplexify <From>::type, Eigen::ColMajor>(X, threads);
+    }
+
+    /*! @brief 1変量時系列のDCT-3
+        @tparam To 実数型または複素数型．指定しないと実数型になる
+        @tparam From 実数型または複素数型
+        @tparam N 系列の長さ
+        @param x 1変量時系列
+    */
+
+    /*! @brief std::array用
+    */
+
+    /*! @brief 型指定する場合
+    */
+    template <typename To, typename From, size_t N>
+    std::array <To, N> dct3(const std::array <From, N> &x)
+    {
+        std::array <To, N> retval;
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::III, FFT_DIRECTION::FORWARD>(N).execute(x.data(), retval.data());
+
+        return retval;
+    }
+
+    /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため
+    */
+    template <size_t N, typename From>
+    std::array <typename std::decomplexify <From>::type, N> dct3(const std::array <From, N> &x)
+    {
+        return dct3 <typename std::decomplexify <From>::type>(x);
+    }
+
+    /*! @brief 出力先を指定する場合．確保をしない
+    */
+    template <typename To, typename From, size_t N>
+    void dct3(const std::array <From, N> &x, std::array <To, N> &X)
+    {
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::III, FFT_DIRECTION::FORWARD>(N).execute(x.data(), X.data());
+    }
+
+    /*! @brief std::vector用
+    */
+
+    /*! @brief 型指定する場合
+    */
+    template <typename To, typename From>
+    std::vector <To> dct3(const std::vector <From> &x)
+    {
+        std::vector <To> retval(x.size());
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::III, FFT_DIRECTION::FORWARD>(x.size()).execute(x.data(), retval.data());
+
+        return retval;
+    }
+
+    /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため．
+        先頭の非型引数は，型指定した呼び出しがこちらにも当たって曖昧にならないようにするため（std::array用のNと同じ）
+    */
+    template <int = 0, typename From>
+    std::vector <typename std::decomplexify <From>::type> dct3(const std::vector <From> &x)
+    {
+        return dct3 <typename std::decomplexify <From>::type, From>(x);
+    }
+
+    /*! @brief 出力先を指定する場合．Xの大きさが合っていれば確保をしない
+    */
+    template <typename To, typename From>
+    void dct3(const std::vector <From> &x, std::vector <To> &X)
+    {
+        X.resize(x.size());
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::III, FFT_DIRECTION::FORWARD>(x.size()).execute(x.data(), X.data());
+    }
+
+    /*! @brief 多変量時系列のDCT-3
+        @tparam To 実数型または複素数型．指定しないと実数型になる
+        @tparam Option 時間方向の縦横．デフォルト値はEigen::ColMajorでこのとき時間方向は縦
+        @tparam From 実数型または複素数型
+        @tparam Rows 行数
+        @tparam Cols 列数
+        @param X データ行列
+        @param threads スレッド数．系列を分担する
+    */
+
+    /*! @brief Eigen::Matrix用
+    */
+
+    /*! @brief 型指定する，方向指定する場合
+    */
+    template <typename To, int Option, typename From, int Rows, int Cols>
+    Eigen::Matrix <To, Rows, Cols> dct3(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
+    {
+        return dct_series <DCT_TYPE::III, FFT_DIRECTION::FORWARD, To, Option>(X, threads);
+    }
+
+    /*! @brief 型指定する，方向指定しない場合を担保
+    */
+    template <typename To, int Rows, int Cols, typename From>
+    Eigen::Matrix <To, Rows, Cols> dct3(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
+    {
+        return dct3 <To, Eigen::ColMajor>(X, threads);
+    }
+
+    /*! @brief 型指定しない，方向指定する場合を担保
+    */
+    template <int Option, int Rows, int Cols, typename From>
+    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> dct3(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
+    {
+        return dct3 <typename std::decomplexify <From>::type, Option>(X, threads);
+    }
+
+    /*! @brief 型指定しない，方向指定しない場合を担保
+    */
+    template <int Rows, int Cols, typename From>
+    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> dct3(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
+    {
+        return dct3 <typename std::decomplexify <From>::type, Eigen::ColMajor>(X, threads);
+    }
+
+    /*! @brief 1変量時系列のiDCT-3（DCT-2の2/N倍）
+        @tparam To 実数型または複素数型．指定しないと実数型になる
+        @tparam From 実数型または複素数型
+        @tparam N 系列の長さ
+        @param x 1変量時系列
+    */
+
+    /*! @brief std::array用
+    */
+
+    /*! @brief 型指定する場合
+    */
+    template <typename To, typename From, size_t N>
+    std::array <To, N> idct3(const std::array <From, N> &x)
+    {
+        std::array <To, N> retval;
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::III, FFT_DIRECTION::INVERSE>(N).execute(x.data(), retval.data());
+
+        return retval;
+    }
+
+    /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため
+    */
+    template <size_t N, typename From>
+    std::array <typename std::decomplexify <From>::type, N> idct3(const std::array <From, N> &x)
+    {
+        return idct3 <typename std::decomplexify <From>::type>(x);
+    }
+
+    /*! @brief 出力先を指定する場合．確保をしない
+    */
+    template <typename To, typename From, size_t N>
+    void idct3(const std::array <From, N> &x, std::array <To, N> &X)
+    {
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::III, FFT_DIRECTION::INVERSE>(N).execute(x.data(), X.data());
+    }
+
+    /*! @brief std::vector用
+    */
+
+    /*! @brief 型指定する場合
+    */
+    template <typename To, typename From>
+    std::vector <To> idct3(const std::vector <From> &x)
+    {
+        std::vector <To> retval(x.size());
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::III, FFT_DIRECTION::INVERSE>(x.size()).execute(x.data(), retval.data());
+
+        return retval;
+    }
+
+    /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため．
+        先頭の非型引数は，型指定した呼び出しがこちらにも当たって曖昧にならないようにするため（std::array用のNと同じ）
+    */
+    template <int = 0, typename From>
+    std::vector <typename std::decomplexify <From>::type> idct3(const std::vector <From> &x)
+    {
+        return idct3 <typename std::decomplexify <From>::type, From>(x);
+    }
+
+    /*! @brief 出力先を指定する場合．Xの大きさが合っていれば確保をしない
+    */
+    template <typename To, typename From>
+    void idct3(const std::vector <From> &x, std::vector <To> &X)
+    {
+        X.resize(x.size());
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::III, FFT_DIRECTION::INVERSE>(x.size()).execute(x.data(), X.data());
+    }
+
+    /*! @brief 多変量時系列のiDCT-3（DCT-2の2/N倍）
+        @tparam To 実数型または複素数型．指定しないと実数型になる
+        @tparam Option 時間方向の縦横．デフォルト値はEigen::ColMajorでこのとき時間方向は縦
+        @tparam From 実数型または複素数型
+        @tparam Rows 行数
+        @tparam Cols 列数
+        @param X データ行列
+        @param threads スレッド数．系列を分担する
+    */
+
+    /*! @brief Eigen::Matrix用
+    */
+
+    /*! @brief 型指定する，方向指定する場合
+    */
+    template <typename To, int Option, typename From, int Rows, int Cols>
+    Eigen::Matrix <To, Rows, Cols> idct3(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
+    {
+        return dct_series <DCT_TYPE::III, FFT_DIRECTION::INVERSE, To, Option>(X, threads);
+    }
+
+    /*! @brief 型指定する，方向指定しない場合を担保
+    */
+    template <typename To, int Rows, int Cols, typename From>
+    Eigen::Matrix <To, Rows, Cols> idct3(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
+    {
+        return idct3 <To, Eigen::ColMajor>(X, threads);
+    }
+
+    /*! @brief 型指定しない，方向指定する場合を担保
+    */
+    template <int Option, int Rows, int Cols, typename From>
+    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> idct3(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
+    {
+        return idct3 <typename std::decomplexify <From>::type, Option>(X, threads);
+    }
+
+    /*! @brief 型指定しない，方向指定しない場合を担保
+    */
+    template <int Rows, int Cols, typename From>
+    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> idct3(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
+    {
+        return idct3 <typename std::decomplexify <From>::type, Eigen::ColMajor>(X, threads);
+    }
+
+    /*! @brief 1変量時系列のDCT-4
+        @tparam To 実数型または複素数型．指定しないと実数型になる
+        @tparam From 実数型または複素数型
+        @tparam N 系列の長さ
+        @param x 1変量時系列
+    */
+
+    /*! @brief std::array用
+    */
+
+    /*! @brief 型指定する場合
+    */
+    template <typename To, typename From, size_t N>
+    std::array <To, N> dct4(const std::array <From, N> &x)
+    {
+        std::array <To, N> retval;
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::IV, FFT_DIRECTION::FORWARD>(N).execute(x.data(), retval.data());
+
+        return retval;
+    }
+
+    /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため
+    */
+    template <size_t N, typename From>
+    std::array <typename std::decomplexify <From>::type, N> dct4(const std::array <From, N> &x)
+    {
+        return dct4 <typename std::decomplexify <From>::type>(x);
+    }
+
+    /*! @brief 出力先を指定する場合．確保をしない
+    */
+    template <typename To, typename From, size_t N>
+    void dct4(const std::array <From, N> &x, std::array <To, N> &X)
+    {
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::IV, FFT_DIRECTION::FORWARD>(N).execute(x.data(), X.data());
+    }
+
+    /*! @brief std::vector用
+    */
+
+    /*! @brief 型指定する場合
+    */
+    template <typename To, typename From>
+    std::vector <To> dct4(const std::vector <From> &x)
+    {
+        std::vector <To> retval(x.size());
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::IV, FFT_DIRECTION::FORWARD>(x.size()).execute(x.data(), retval.data());
+
+        return retval;
+    }
+
+    /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため．
+        先頭の非型引数は，型指定した呼び出しがこちらにも当たって曖昧にならないようにするため（std::array用のNと同じ）
+    */
+    template <int = 0, typename From>
+    std::vector <typename std::decomplexify <From>::type> dct4(const std::vector <From> &x)
+    {
+        return dct4 <typename std::decomplexify <From>::type, From>(x);
+    }
+
+    /*! @brief 出力先を指定する場合．Xの大きさが合っていれば確保をしない
+    */
+    template <typename To, typename From>
+    void dct4(const std::vector <From> &x, std::vector <To> &X)
+    {
+        X.resize(x.size());
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::IV, FFT_DIRECTION::FORWARD>(x.size()).execute(x.data(), X.data());
+    }
+
+    /*! @brief 多変量時系列のDCT-4
+        @tparam To 実数型または複素数型．指定しないと実数型になる
+        @tparam Option 時間方向の縦横．デフォルト値はEigen::ColMajorでこのとき時間方向は縦
+        @tparam From 実数型または複素数型
+        @tparam Rows 行数
+        @tparam Cols 列数
+        @param X データ行列
+        @param threads スレッド数．系列を分担する
+    */
+
+    /*! @brief Eigen::Matrix用
+    */
+
+    /*! @brief 型指定する，方向指定する場合
+    */
+    template <typename To, int Option, typename From, int Rows, int Cols>
+    Eigen::Matrix <To, Rows, Cols> dct4(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
+    {
+        return dct_series <DCT_TYPE::IV, FFT_DIRECTION::FORWARD, To, Option>(X, threads);
+    }
+
+    /*! @brief 型指定する，方向指定しない場合を担保
+    */
+    template <typename To, int Rows, int Cols, typename From>
+    Eigen::Matrix <To, Rows, Cols> dct4(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
+    {
+        return dct4 <To, Eigen::ColMajor>(X, threads);
+    }
+
+    /*! @brief 型指定しない，方向指定する場合を担保
+    */
+    template <int Option, int Rows, int Cols, typename From>
+    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> dct4(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
+    {
+        return dct4 <typename std::decomplexify <From>::type, Option>(X, threads);
+    }
+
+    /*! @brief 型指定しない，方向指定しない場合を担保
+    */
+    template <int Rows, int Cols, typename From>
+    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> dct4(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
+    {
+        return dct4 <typename std::decomplexify <From>::type, Eigen::ColMajor>(X, threads);
+    }
+
+    /*! @brief 1変量時系列のiDCT-4（DCT-4の2/N倍）
+        @tparam To 実数型または複素数型．指定しないと実数型になる
+        @tparam From 実数型または複素数型
+        @tparam N 系列の長さ
+        @param x 1変量時系列
+    */
+
+    /*! @brief std::array用
+    */
+
+    /*! @brief 型指定する場合
+    */
+    template <typename To, typename From, size_t N>
+    std::array <To, N> idct4(const std::array <From, N> &x)
+    {
+        std::array <To, N> retval;
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::IV, FFT_DIRECTION::INVERSE>(N).execute(x.data(), retval.data());
+
+        return retval;
+    }
+
+    /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため
+    */
+    template <size_t N, typename From>
+    std::array <typename std::decomplexify <From>::type, N> idct4(const std::array <From, N> &x)
+    {
+        return idct4 <typename std::decomplexify <From>::type>(x);
+    }
+
+    /*! @brief 出力先を指定する場合．確保をしない
+    */
+    template <typename To, typename From, size_t N>
+    void idct4(const std::array <From, N> &x, std::array <To, N> &X)
+    {
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::IV, FFT_DIRECTION::INVERSE>(N).execute(x.data(), X.data());
+    }
+
+    /*! @brief std::vector用
+    */
+
+    /*! @brief 型指定する場合
+    */
+    template <typename To, typename From>
+    std::vector <To> idct4(const std::vector <From> &x)
+    {
+        std::vector <To> retval(x.size());
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::IV, FFT_DIRECTION::INVERSE>(x.size()).execute(x.data(), retval.data());
+
+        return retval;
+    }
+
+    /*! @brief 型指定しない場合は実数型になる．原系列が実数型なら変換後も実数型になるため．
+        先頭の非型引数は，型指定した呼び出しがこちらにも当たって曖昧にならないようにするため（std::array用のNと同じ）
+    */
+    template <int = 0, typename From>
+    std::vector <typename std::decomplexify <From>::type> idct4(const std::vector <From> &x)
+    {
+        return idct4 <typename std::decomplexify <From>::type, From>(x);
+    }
+
+    /*! @brief 出力先を指定する場合．Xの大きさが合っていれば確保をしない
+    */
+    template <typename To, typename From>
+    void idct4(const std::vector <From> &x, std::vector <To> &X)
+    {
+        X.resize(x.size());
+        dct_plan <typename std::decomplexify <To>::type, DCT_TYPE::IV, FFT_DIRECTION::INVERSE>(x.size()).execute(x.data(), X.data());
+    }
+
+    /*! @brief 多変量時系列のiDCT-4（DCT-4の2/N倍）
+        @tparam To 実数型または複素数型．指定しないと実数型になる
+        @tparam Option 時間方向の縦横．デフォルト値はEigen::ColMajorでこのとき時間方向は縦
         @tparam From 実数型または複素数型
         @tparam Rows 行数
         @tparam Cols 列数
         @param X データ行列
-        @param option 時間方向の縦横．デフォルト値はEigen::ColMajorでこのとき時間方向は縦
+        @param threads スレッド数．系列を分担する
     */
 
     /*! @brief Eigen::Matrix用
@@ -826,36 +1683,33 @@ namespace Eigen {
     /*! @brief 型指定する，方向指定する場合
     */
     template <typename To, int Option, typename From, int Rows, int Cols>
-    Eigen::Matrix <To, Rows, Cols> idct2(const Eigen::Matrix <From, Rows, Cols> &X)
+    Eigen::Matrix <To, Rows, Cols> idct4(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
     {
-        _PRINT(ievenize2<Option>(X))
-        _PRINT(ifft <To>(ievenize2<Option>(X), Option))
-        _PRINT(ideevenize2<Option>(ifft <To>(ievenize2<Option>(X), Option)))
-        return ideevenize2 <Option>(ifft <To>(ievenize2 <Option>(X), Option)) * 2.;
+        return dct_series <DCT_TYPE::IV, FFT_DIRECTION::INVERSE, To, Option>(X, threads);
     }
 
     /*! @brief 型指定する，方向指定しない場合を担保
     */
     template <typename To, int Rows, int Cols, typename From>
-    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> idct2(const Eigen::Matrix <From, Rows, Cols> &X)
+    Eigen::Matrix <To, Rows, Cols> idct4(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
     {
-        return idct2 <To, Eigen::ColMajor>(X);
+        return idct4 <To, Eigen::ColMajor>(X, threads);
     }
 
     /*! @brief 型指定しない，方向指定する場合を担保
     */
     template <int Option, int Rows, int Cols, typename From>
-    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> idct2(const Eigen::Matrix <From, Rows, Cols> &X)
+    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> idct4(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
     {
-        return idct2 <typename std::decomplexify <From>::type, Option>(X);
+        return idct4 <typename std::decomplexify <From>::type, Option>(X, threads);
     }
 
     /*! @brief 型指定しない，方向指定しない場合を担保
     */
     template <int Rows, int Cols, typename From>
-    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> idct2(const Eigen::Matrix <From, Rows, Cols> &X)
+    Eigen::Matrix <typename std::decomplexify <From>::type, Rows, Cols> idct4(const Eigen::Matrix <From, Rows, Cols> &X, const size_t threads = 1)
     {
-        return idct2 <typename std::decomplexify <From>::type, Eigen::ColMajor>(X);
+        return idct4 <typename std::decomplexify <From>::type, Eigen::ColMajor>(X, threads);
     }
 }
 
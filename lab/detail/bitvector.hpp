@@ -0,0 +1,656 @@
+#ifndef DETAIL_BITVECTOR
+#define DETAIL_BITVECTOR
+
+#include <cstring>
+#include <limits>
+#include <new>
+#include <sstream>
+#include "../bitvector.hpp"
+
+namespace bitvector {
+    inline Bitvector::Bitvector()
+        : _length(0), _line_num(0), _ones(0), _lines(nullptr), _select1_hint(nullptr), _select0_hint(nullptr)
+    {
+        make_empty();
+    }
+
+    inline Bitvector::Bitvector(const position_t n)
+        : _length(0), _line_num(0), _ones(0), _lines(nullptr), _select1_hint(nullptr), _select0_hint(nullptr)
+    {
+        allocate(n);
+        build();
+    }
+
+    inline Bitvector::Bitvector(const std::vector <bool> &org_array)
+        : _length(0), _line_num(0), _ones(0), _lines(nullptr), _select1_hint(nullptr), _select0_hint(nullptr)
+    {
+        allocate(org_array.size());
+        for (position_t i = 0; i < _length; i++) {
+            if (org_array[i]) {
+                set(i);
+            }
+        }
+        build();
+    }
+
+    inline Bitvector::Bitvector(const std::string &org_array)
+        : _length(0), _line_num(0), _ones(0), _lines(nullptr), _select1_hint(nullptr), _select0_hint(nullptr)
+    {
+        allocate(org_array.size());
+        for (position_t i = 0; i < _length; i++) {
+            if (org_array[i] == '1') {
+                set(i);
+            }
+        }
+        build();
+    }
+
+    inline Bitvector::~Bitvector()
+    {
+        release();
+    }
+
+    inline Bitvector::Bitvector(const Bitvector &other)
+        : _length(0), _line_num(0), _ones(other._ones), _lines(nullptr), _select1_hint(nullptr), _select0_hint(nullptr)
+    {
+        if (!other.owns_lines()) {
+            // ファイルのページや長さ0の共有ラインは読み込み専用なので共有する．
+            _length       = other._length;
+            _line_num     = other._line_num;
+            _lines        = other._lines;
+            _select1_hint = other._select1_hint;
+            _select0_hint = other._select0_hint;
+            _file         = other._file;
+        } else {
+            allocate(other._length);
+            std::memcpy(_lines, other._lines, _line_num * line_words * sizeof(std::uint64_t));
+            _hints = other._hints;
+            bind_hints();
+        }
+    }
+
+    inline Bitvector&Bitvector::operator=(const Bitvector &other)
+    {
+        if (this != &other) {
+            Bitvector tmp(other);
+            *this = std::move(tmp);
+        }
+
+        return *this;
+    }
+
+    // vectorのムーブでは要素の場所は変わらないので，標本へのポインタもそのまま使える．
+    inline Bitvector::Bitvector(Bitvector &&other) noexcept
+        : _length(other._length), _line_num(other._line_num), _ones(other._ones), _lines(other._lines), _hints(std::move(other._hints)),
+        _select1_hint(other._select1_hint), _select0_hint(other._select0_hint), _file(std::move(other._file))
+    {
+        other.make_empty();
+    }
+
+    inline Bitvector&Bitvector::operator=(Bitvector &&other) noexcept
+    {
+        if (this != &other) {
+            release();
+            _length       = other._length;
+            _line_num     = other._line_num;
+            _ones         = other._ones;
+            _lines        = other._lines;
+            _hints        = std::move(other._hints);
+            _select1_hint = other._select1_hint;
+            _select0_hint = other._select0_hint;
+            _file         = std::move(other._file);
+            other.make_empty();
+        }
+
+        return *this;
+    }
+
+    inline void Bitvector::allocate(const position_t n)
+    {
+        // index = nのrankも同じ式で引けるように，常にn / line_bits + 1本とる．
+        const position_t line_num = n / line_bits + 1;
+        const size_t     bytes    = line_num * line_words * sizeof(std::uint64_t);
+        std::uint64_t   *lines    = static_cast <std::uint64_t *>(aligned_alloc(64, bytes));
+        if (lines == nullptr) {
+            throw std::bad_alloc();
+        }
+        std::memset(lines, 0, bytes);
+        release();
+        _file.reset();
+        _length   = n;
+        _line_num = line_num;
+        _lines    = lines;
+    }
+
+    inline std::uint64_t *Bitvector::empty_lines()
+    {
+        // 長さ0ではbuildもsetもしないので書き込まれない．
+        alignas(64) static std::uint64_t lines[line_words] = {};
+
+        return lines;
+    }
+
+    inline const Bitvector::position_t *Bitvector::empty_hints()
+    {
+        // 1と0の標本がそれぞれ番兵（最後のライン0）だけ
+        static const position_t hints[2] = { 0, 0 };
+
+        return hints;
+    }
+
+    inline bool Bitvector::owns_lines() const
+    {
+        return !_file && _lines != empty_lines();
+    }
+
+    inline void Bitvector::release() noexcept
+    {
+        if (owns_lines()) {
+            std::free(_lines);
+        }
+        _lines = nullptr;
+    }
+
+    inline void Bitvector::make_empty() noexcept
+    {
+        _length       = 0;
+        _line_num     = 1;
+        _ones         = 0;
+        _lines        = empty_lines();
+        _hints.clear();
+        _select1_hint = empty_hints();
+        _select0_hint = empty_hints() + 1;
+        _file.reset();
+    }
+
+    inline std::uint64_t Bitvector::layout()
+    {
+        return (std::uint64_t(line_words) << 32) | select_sample;
+    }
+
+    inline size_t Bitvector::hint_num(const time_t count)
+    {
+        return (count + select_sample - 1) / select_sample + 1;
+    }
+
+    inline void Bitvector::bind_hints()
+    {
+        _select1_hint = _hints.data();
+        _select0_hint = _hints.data() + hint_num(_ones);
+    }
+
+    inline bool Bitvector::valid_hints(const position_t *hints, const size_t num, const position_t line_num)
+    {
+        for (size_t i = 0; i < num; i++) {
+            if (hints[i] >= line_num || (i > 0 && hints[i] < hints[i - 1])) {
+                return false;
+            }
+        }
+
+        return num > 0 && hints[num - 1] == line_num - 1;
+    }
+
+    inline void Bitvector::set(const position_t index, const bool bit)
+    {
+        std::uint64_t      &word = _lines[(index / line_bits) * line_words + 1 + (index % line_bits) / 64];
+        const std::uint64_t mask = std::uint64_t(1) << (index % 64);
+        word = bit ? (word | mask) : (word & ~mask);
+    }
+
+    inline void Bitvector::set_word(const position_t index, const std::uint64_t word)
+    {
+        _lines[(index / line_bits) * line_words + 1 + (index % line_bits) / 64] = word;
+    }
+
+    inline void Bitvector::build(parallel::Thread_pool *pool)
+    {
+        if (!owns_lines()) {
+            return;
+        }
+        // build_grainライン単位のブロックに分け，ブロック内の累積と合計を並列に求めてからずらす．
+        const position_t block_num = (_line_num + build_grain - 1) / build_grain;
+        std::vector <time_t> block_ones(block_num + 1, 0);
+        parallel::for_range(pool, 0, block_num, [this, &block_ones](const std::ptrdiff_t first, const std::ptrdiff_t last) {
+            for (position_t block = first; block < position_t(last); block++) {
+                time_t sum = 0;
+                for (position_t line = block * build_grain; line < std::min((block + 1) * build_grain, _line_num); line++) {
+                    std::uint64_t *p = _lines + line * line_words;
+                    p[0] = sum;
+                    for (position_t w = 1; w < line_words; w++) {
+                        sum += popcount(p[w]);
+                    }
+                }
+                block_ones[block + 1] = sum;
+            }
+        });
+        for (position_t block = 0; block < block_num; block++) {
+            block_ones[block + 1] += block_ones[block];
+        }
+        _ones = block_ones[block_num];
+
+        // 各ブロックにずれを足し，そのブロックのselectの標本を作る．
+        // k * select_sample + 1番目の1（0）が入っているライン．
+        const time_t zeros = _length - _ones;
+        std::vector <std::vector <position_t> > hint1(block_num), hint0(block_num);
+        parallel::for_range(pool, 0, block_num, [this, zeros, &block_ones, &hint1, &hint0](const std::ptrdiff_t first, const std::ptrdiff_t last) {
+            for (position_t block = first; block < position_t(last); block++) {
+                const position_t begin  = block * build_grain;
+                const position_t end    = std::min((block + 1) * build_grain, _line_num);
+                const time_t     offset = block_ones[block];
+                for (position_t line = begin; line < end; line++) {
+                    _lines[line * line_words] += offset;
+                }
+                // ブロックより前の1（0）の数より大きい最初の標本から
+                time_t next1 = (offset + select_sample - 1) / select_sample * select_sample + 1;
+                time_t next0 = (begin * line_bits - offset + select_sample - 1) / select_sample * select_sample + 1;
+                for (position_t line = begin; line < end; line++) {
+                    const time_t ones_end  = (line + 1 < end) ? _lines[(line + 1) * line_words] : block_ones[block + 1];
+                    const time_t zeros_end = std::min((line + 1) * line_bits - ones_end, zeros);
+                    for (; next1 <= ones_end && next1 <= _ones; next1 += select_sample) {
+                        hint1[block].push_back(line);
+                    }
+                    for (; next0 <= zeros_end; next0 += select_sample) {
+                        hint0[block].push_back(line);
+                    }
+                }
+            }
+        });
+        _hints.clear();
+        _hints.reserve(hint_num(_ones) + hint_num(zeros));
+        for (position_t block = 0; block < block_num; block++) {
+            _hints.insert(_hints.end(), hint1[block].begin(), hint1[block].end());
+        }
+        _hints.push_back(_line_num - 1);
+        for (position_t block = 0; block < block_num; block++) {
+            _hints.insert(_hints.end(), hint0[block].begin(), hint0[block].end());
+        }
+        _hints.push_back(_line_num - 1);
+        bind_hints();
+    }
+
+    inline bool Bitvector::operator[](const position_t index) const
+    {
+        return (_lines[(index / line_bits) * line_words + 1 + (index % line_bits) / 64] >> (index % 64)) & 1;
+    }
+
+    inline void Bitvector::prefetch(const position_t index) const
+    {
+#if defined(__GNUC__)
+        __builtin_prefetch(_lines + (std::min(index, _length) / line_bits) * line_words);
+#endif
+    }
+
+    inline void Bitvector::prefetch_select(const unsigned long a, const time_t order) const
+    {
+#if defined(__GNUC__)
+        if (order > 0 && order <= count(a)) {
+            __builtin_prefetch(((a == 0) ? _select0_hint : _select1_hint) + (order - 1) / select_sample);
+        }
+#endif
+    }
+
+    inline unsigned long Bitvector::access(const position_t index) const
+    {
+        if (index <= 0 || index > _length) {
+            return invalid_value();
+        }
+
+        return (*this)[index - 1];
+    }
+
+    inline Bitvector::time_t Bitvector::rank1(const position_t index) const
+    {
+        const position_t     i      = std::min(index, _length);
+        const std::uint64_t *p      = _lines + (i / line_bits) * line_words;
+        const position_t     offset = i % line_bits;
+        time_t               retval = p[0];
+        for (position_t w = 0; w < offset / 64; w++) {
+            retval += popcount(p[1 + w]);
+        }
+        if (offset % 64 != 0) {
+            retval += popcount(p[1 + offset / 64] & ((std::uint64_t(1) << (offset % 64)) - 1));
+        }
+
+        return retval;
+    }
+
+    inline unsigned long Bitvector::rank(const unsigned long a, const position_t index) const
+    {
+        if (a == 0) {
+            return std::min(index, _length) - rank1(index);
+        } else if (a == 1) {
+            return rank1(index);
+        } else {
+            return invalid_value();
+        }
+    }
+
+    inline Bitvector::time_t Bitvector::line_rank0(const position_t line) const
+    {
+        return line * line_bits - _lines[line * line_words];
+    }
+
+    template <class Rank>
+    inline Bitvector::position_t Bitvector::search_line(position_t lower, position_t upper, const time_t order, Rank &&line_rank) const
+    {
+        // ラインの先頭の数が線形に増えるとみて補間した位置で区間を分け，残りを2分探索と線形探索で絞る．
+        // 偏りが小さければ1, 2本読むだけで済み，偏っていてもO(log(upper - lower))．
+        const time_t lower_rank = line_rank(lower);
+        const time_t upper_rank = line_rank(upper);
+        if (upper > lower && upper_rank > lower_rank) {
+            position_t guess = lower + (upper - lower) * (order - 1 - lower_rank) / (upper_rank - lower_rank);
+            guess = std::min(std::max(guess, lower), upper);
+            if (line_rank(guess) < order) {
+                lower = guess;
+                // 補間がほぼ当たっていれば次のラインで止まる
+                if (lower < upper && line_rank(lower + 1) >= order) {
+                    return lower;
+                }
+            } else {
+                upper = guess - 1;
+            }
+        }
+        while (upper - lower > 8) {
+            const position_t center = (lower + upper + 1) / 2;
+            if (line_rank(center) < order) {
+                lower = center;
+            } else {
+                upper = center - 1;
+            }
+        }
+        position_t line = lower;
+        while (line < upper && line_rank(line + 1) < order) {
+            line++;
+        }
+
+        return line;
+    }
+
+    inline Bitvector::position_t Bitvector::select1(const time_t order) const
+    {
+        if (order <= 0) {
+            return 0;
+        } else if (order > _ones) {
+            return invalid_value();
+        }
+
+        // 標本の間でラインの先頭の1の数がorder未満の最後のラインを探す．
+        const time_t     sample = (order - 1) / select_sample;
+        const position_t lower  = search_line(_select1_hint[sample], _select1_hint[sample + 1], order, [this](const position_t line) {
+                                                  return _lines[line * line_words];
+                                              });
+
+        // ラインの中の線形探索と語内の選択．
+        // ラインの先頭の数が壊れたファイルでもラインの外は読まない．
+        const std::uint64_t *p          = _lines + lower * line_words;
+        time_t               rest_order = order - p[0];
+        for (position_t w = 1; w < line_words; w++) {
+            const time_t count = popcount(p[w]);
+            if (rest_order <= count) {
+                return lower * line_bits + (w - 1) * 64 + select_in_word(p[w], rest_order - 1) + 1;
+            }
+            rest_order -= count;
+        }
+
+        return invalid_value();
+    }
+
+    inline Bitvector::position_t Bitvector::select0(const time_t order) const
+    {
+        if (order <= 0) {
+            return 0;
+        } else if (order > _length - _ones) {
+            return invalid_value();
+        }
+
+        const time_t     sample = (order - 1) / select_sample;
+        const position_t lower  = search_line(_select0_hint[sample], _select0_hint[sample + 1], order, [this](const position_t line) {
+                                                  return line_rank0(line);
+                                              });
+
+        const std::uint64_t *p          = _lines + lower * line_words;
+        time_t               rest_order = order - line_rank0(lower);
+        for (position_t w = 1; w < line_words; w++) {
+            const time_t count = 64 - popcount(p[w]);
+            if (rest_order <= count) {
+                return lower * line_bits + (w - 1) * 64 + select_in_word(~p[w], rest_order - 1) + 1;
+            }
+            rest_order -= count;
+        }
+
+        return invalid_value();
+    }
+
+    inline unsigned long Bitvector::select(const unsigned long a, const time_t order) const
+    {
+        if (a == 0) {
+            return select0(order);
+        } else if (a == 1) {
+            return select1(order);
+        } else {
+            return invalid_value();
+        }
+    }
+
+    inline size_t Bitvector::size() const
+    {
+        return _length;
+    }
+
+    inline size_t Bitvector::count(const unsigned long a) const
+    {
+        return (a == 0) ? _length - _ones : _ones;
+    }
+
+    inline size_t Bitvector::bytes() const
+    {
+        return _line_num * line_words * sizeof(std::uint64_t) + (hint_num(_ones) + hint_num(_length - _ones)) * sizeof(position_t);
+    }
+
+    inline std::string Bitvector::to_string() const
+    {
+        std::string result(_length, '0');
+        for (position_t i = 0; i < _length; i++) {
+            if ((*this)[i]) {
+                result[i] = '1';
+            }
+        }
+
+        return result;
+    }
+
+    inline unsigned long Bitvector::invalid_value() const
+    {
+        return std::numeric_limits <unsigned long>::max();
+    }
+
+    inline std::string Bitvector::str() const
+    {
+        std::string result = "";
+        // 全体のビット長
+        result += "length: " + std::to_string(_length) + '\n';
+        result += "ones: " + std::to_string(_ones) + '\n';
+        // ラインについて
+        result += "line_bits: " + std::to_string(line_bits) + '\n';
+        result += "line_num: " + std::to_string(_line_num) + '\n';
+        // selectの標本について
+        result += "select_sample: " + std::to_string(select_sample) + '\n';
+        result += "select1_hint_num: " + std::to_string(hint_num(_ones)) + '\n';
+        result += "select0_hint_num: " + std::to_string(hint_num(_length - _ones)) + '\n';
+        result += "bytes: " + std::to_string(bytes()) + '\n';
+
+        return result;
+    }
+
+    inline std::ostream&operator<<(std::ostream &os, const Bitvector &bv)
+    {
+        os << bv.to_string();
+
+        return os;
+    }
+
+    inline std::ostream &Bitvector::write(std::ostream &os) const
+    {
+        succinct::bin::write_header(os, succinct::bin::make_header(succinct::bin::BIT_VECTOR, _length, _ones, layout()));
+        succinct::bin::write_section(os, _lines, _line_num * line_words * sizeof(std::uint64_t));
+        succinct::bin::write_section(os, _select1_hint, hint_num(_ones) * sizeof(position_t));
+        succinct::bin::write_section(os, _select0_hint, hint_num(_length - _ones) * sizeof(position_t));
+
+        return os;
+    }
+
+    inline std::istream &Bitvector::read(std::istream &is)
+    {
+        succinct::bin::Header header;
+        if (!succinct::bin::read_header(is, header) || !succinct::bin::check_header(header, succinct::bin::BIT_VECTOR, layout()) || header.count > header.length) {
+            is.setstate(std::ios_base::failbit);
+
+            return is;
+        }
+        // 長さはファイルの値なので，ラインを確保する前に残りのバイト数と比べる．
+        // シークできなければ比べられないので，確保に失敗したら読めなかったことにする．
+        const std::streamoff rest = succinct::bin::remaining(is);
+        if (rest >= 0 && header.length / line_bits + 1 > static_cast <std::uint64_t>(rest) / (line_words * sizeof(std::uint64_t))) {
+            is.setstate(std::ios_base::failbit);
+            release();
+            make_empty();
+
+            return is;
+        }
+        try {
+            allocate(header.length);
+            _ones = header.count;
+            _hints.resize(hint_num(_ones) + hint_num(_length - _ones));
+        } catch (const std::bad_alloc &) {
+            is.setstate(std::ios_base::failbit);
+            release();
+            make_empty();
+
+            return is;
+        }
+        bind_hints();
+        if (!succinct::bin::read_section(is, _lines, _line_num * line_words * sizeof(std::uint64_t)) ||
+            !succinct::bin::read_section(is, _hints.data(), hint_num(_ones) * sizeof(position_t)) ||
+            !succinct::bin::read_section(is, _hints.data() + hint_num(_ones), hint_num(_length - _ones) * sizeof(position_t)) ||
+            !valid_hints(_select1_hint, hint_num(_ones), _line_num) || !valid_hints(_select0_hint, hint_num(_length - _ones), _line_num)) {
+            // 途中で切れているか標本が壊れていれば空に戻す．
+            is.setstate(std::ios_base::failbit);
+            release();
+            make_empty();
+        }
+
+        return is;
+    }
+
+    inline bool Bitvector::attach(const std::shared_ptr <const Mapped_file> &file, const std::size_t offset)
+    {
+        succinct::bin::Header header;
+        if (!file || !succinct::bin::read_header(*file, offset, header) || !succinct::bin::check_header(header, succinct::bin::BIT_VECTOR, layout()) || header.count > header.length) {
+            return false;
+        }
+        // 長さから求めるバイト数があふれないよう，先にファイルの大きさと比べる．
+        if (header.length / line_bits + 1 > file->size() / (line_words * sizeof(std::uint64_t))) {
+            return false;
+        }
+        const size_t line_bytes  = (header.length / line_bits + 1) * line_words * sizeof(std::uint64_t);
+        const size_t hint1_bytes = hint_num(header.count) * sizeof(position_t);
+        const size_t hint0_bytes = hint_num(header.length - header.count) * sizeof(position_t);
+        if (offset + sizeof(header) + line_bytes + succinct::bin::padded(hint1_bytes) + succinct::bin::padded(hint0_bytes) > file->size()) {
+            return false;
+        }
+        const unsigned char *p        = file->data() + offset + sizeof(header);
+        const position_t    *hint1    = reinterpret_cast <const position_t *>(p + line_bytes);
+        const position_t    *hint0    = reinterpret_cast <const position_t *>(p + line_bytes + succinct::bin::padded(hint1_bytes));
+        const position_t     line_num = header.length / line_bits + 1;
+        if (!valid_hints(hint1, hint_num(header.count), line_num) || !valid_hints(hint0, hint_num(header.length - header.count), line_num)) {
+            return false;
+        }
+        release();
+        _length       = header.length;
+        _line_num     = line_num;
+        _ones         = header.count;
+        // ページは読み込み専用でマップされている．setしなければ書き込まれない．
+        _lines        = const_cast <std::uint64_t *>(reinterpret_cast <const std::uint64_t *>(p));
+        _select1_hint = hint1;
+        _select0_hint = hint0;
+        _hints.clear();
+        _hints.shrink_to_fit();
+        _file = file;
+
+        return true;
+    }
+
+    inline bool Bitvector::open(const std::string &filename)
+    {
+        const auto file = std::make_shared <Mapped_file>();
+
+        return file->open(filename) && attach(file, 0);
+    }
+
+    inline size_t Bitvector::binary_size() const
+    {
+        return sizeof(succinct::bin::Header) + _line_num * line_words * sizeof(std::uint64_t) +
+               succinct::bin::padded(hint_num(_ones) * sizeof(position_t)) + succinct::bin::padded(hint_num(_length - _ones) * sizeof(position_t));
+    }
+
+    inline void testBitvector()
+    {
+        // Unionbitarrayと同じ例
+        const std::string str    = "1110010010011001000101010100000111110111";
+        const Bitvector   bv     = Bitvector(str);
+        const size_t      length = bv.size();
+        std::cout << bv.str() << std::endl;
+        std::cout << bv << std::endl;
+        for (size_t i = 1; i <= length; i++) {
+            std::cout << "rank0(" << i << ") = " << bv.rank(0, i) << std::endl;
+        }
+        for (size_t i = 1; i <= length; i++) {
+            std::cout << "rank1(" << i << ") = " << bv.rank(1, i) << std::endl;
+        }
+        for (size_t i = 1; i <= length; i++) {
+            std::cout << "access(" << i << ") = " << bv.access(i) << std::endl;
+        }
+        for (size_t i = 1; i <= bv.count(0); i++) {
+            std::cout << "select0(" << i << ") = " << bv.select(0, i) << std::endl;
+        }
+        for (size_t i = 1; i <= bv.count(1); i++) {
+            std::cout << "select1(" << i << ") = " << bv.select(1, i) << std::endl;
+        }
+
+        // 長いビット列で素朴な数え上げと比べる
+        const size_t        n = 3000000;
+        std::vector <bool>  bits(n);
+        std::vector <size_t> ranks(n + 1, 0);
+        std::uint64_t        x = 88172645463325252ULL;
+        for (size_t i = 0; i < n; i++) {
+            x      ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            // 前半は疎，後半は密
+            bits[i]      = (i < n / 2) ? (x % 97 == 0) : (x % 5 != 0);
+            ranks[i + 1] = ranks[i] + bits[i];
+        }
+        const Bitvector big(bits);
+        size_t          errors = 0;
+        for (size_t i = 0; i <= n; i += 7) {
+            errors += (big.rank(1, i) != ranks[i]);
+        }
+        for (size_t i = 0, ones = 0, zeros = 0; i < n; i++) {
+            if (bits[i]) {
+                errors += (big.select(1, ++ones) != i + 1);
+            } else {
+                errors += (big.select(0, ++zeros) != i + 1);
+            }
+        }
+
+        // バイナリ形式で書いて読み戻す
+        std::stringstream ss;
+        big.write(ss);
+        Bitvector loaded;
+        errors += !loaded.read(ss) || (ss.tellg() != std::streampos(big.binary_size()));
+        for (size_t i = 0; i <= n; i += 1009) {
+            errors += (loaded.rank(1, i) != ranks[i]) || (loaded.select(0, i) != big.select(0, i));
+        }
+        std::cout << "errors : " << errors << std::endl;
+    }
+}
+
+#endif
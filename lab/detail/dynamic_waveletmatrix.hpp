@@ -0,0 +1,809 @@
+#ifndef DETAIL_DYNAMIC_WAVELETMATRIX
+#define DETAIL_DYNAMIC_WAVELETMATRIX
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <sstream>
+#include "../dynamic_waveletmatrix.hpp"
+
+namespace waveletmatrix {
+    inline Dynamic_waveletmatrix::Dynamic_waveletmatrix()
+        : _length(0), _depth(0)
+    {
+    }
+
+    inline Dynamic_waveletmatrix::Dynamic_waveletmatrix(const std::vector <element_t> &org_array, const size_t depth, parallel::Thread_pool *pool)
+        : _length(org_array.size()), _depth(depth)
+    {
+        if (_depth == 0) {
+            const element_t max_value = org_array.empty() ? 0 : *std::max_element(org_array.begin(), org_array.end());
+            for (_depth = 1; _depth < 64 && (max_value >> _depth) != 0; _depth++) {
+            }
+        }
+        build(org_array, pool);
+    }
+
+    inline void Dynamic_waveletmatrix::build(const std::vector <element_t> &org_array, parallel::Thread_pool *pool)
+    {
+        // 作業配列は2本で，1要素あたりdepthビットを切り上げたバイト数．
+        if (_depth <= 8) {
+            build_levels <std::uint8_t>(org_array, pool);
+        } else if (_depth <= 16) {
+            build_levels <std::uint16_t>(org_array, pool);
+        } else if (_depth <= 32) {
+            build_levels <std::uint32_t>(org_array, pool);
+        } else {
+            build_levels <std::uint64_t>(org_array, pool);
+        }
+    }
+
+    template <class Word>
+    void Dynamic_waveletmatrix::build_levels(const std::vector <element_t> &org_array, parallel::Thread_pool *pool)
+    {
+        _bitmatrix.clear();
+        _bitmatrix.reserve(_depth);
+        _partition.assign(_depth, 0);
+        {
+            // 前のレベルの並びから次のレベルの並びへ交互に書く．初期化はしない．
+            std::unique_ptr <Word[]> work[2];
+            if (_depth > 1) {
+                work[0].reset(new Word[_length]);
+            }
+            if (_depth > 2) {
+                work[1].reset(new Word[_length]);
+            }
+            partition_level(0, org_array.data(), work[0].get(), pool);
+            for (size_t level = 1; level < _depth; level++) {
+                partition_level(level, work[(level - 1) % 2].get(), (level + 1 < _depth) ? work[level % 2].get() : static_cast <Word *>(nullptr), pool);
+            }
+        }
+
+        // 索引はレベルとブロックの両方で並列に作る．
+        parallel::for_range(pool, 0, _depth, [this, pool](const std::ptrdiff_t first, const std::ptrdiff_t last) {
+            for (size_t level = first; level < size_t(last); level++) {
+                _bitmatrix[level].build(pool);
+            }
+        });
+    }
+
+    template <class Source, class Word>
+    void Dynamic_waveletmatrix::partition_level(const size_t level, const Source *src, Word *dst, parallel::Thread_pool *pool)
+    {
+        const position_t      block_num = (_length + build_block - 1) / build_block;
+        std::vector <position_t> block_zeros(block_num + 1, 0);
+        bitvector::Bitvector  bits(_length);
+
+        // ブロックごとにビットを64個ずつ詰めて書き，0の数を数える．
+        parallel::for_range(pool, 0, block_num, [this, level, src, &block_zeros, &bits](const std::ptrdiff_t first, const std::ptrdiff_t last) {
+            for (position_t block = first; block < position_t(last); block++) {
+                const position_t end   = std::min((block + 1) * build_block, _length);
+                position_t       zeros = 0;
+                for (position_t i = block * build_block; i < end; i += 64) {
+                    const position_t width = std::min <position_t>(64, end - i);
+                    std::uint64_t    word  = 0;
+                    for (position_t j = 0; j < width; j++) {
+                        word |= std::uint64_t(bit_of(src[i + j], level)) << j;
+                    }
+                    bits.set_word(i, word);
+                    zeros += width - bitvector::popcount(word);
+                }
+                block_zeros[block + 1] = zeros;
+            }
+        });
+        for (position_t block = 0; block < block_num; block++) {
+            block_zeros[block + 1] += block_zeros[block];
+        }
+        const position_t zeros = block_zeros[block_num];
+
+        // ブロックより前の0（1）の数から書き出し位置が決まるので，ブロックごとに並列に分配できる．
+        if (dst != nullptr) {
+            parallel::for_range(pool, 0, block_num, [this, level, src, dst, zeros, &block_zeros](const std::ptrdiff_t first, const std::ptrdiff_t last) {
+                for (position_t block = first; block < position_t(last); block++) {
+                    const position_t begin = block * build_block;
+                    const position_t end   = std::min(begin + build_block, _length);
+                    position_t       z     = block_zeros[block];
+                    position_t       o     = zeros + begin - block_zeros[block];
+                    // ビットは予測できないので分岐させない
+                    for (position_t i = begin; i < end; i++) {
+                        const bool bit = bit_of(src[i], level);
+                        dst[bit ? o : z] = src[i];
+                        o += bit;
+                        z += !bit;
+                    }
+                }
+            });
+        }
+
+        _partition[level] = zeros;
+        _bitmatrix.push_back(std::move(bits));
+    }
+
+    inline bool Dynamic_waveletmatrix::bit_of(const element_t value, const size_t level) const
+    {
+        return (value >> (_depth - 1 - level)) & 1;
+    }
+
+    inline Dynamic_waveletmatrix::position_t Dynamic_waveletmatrix::down(const size_t level, const bool bit, const position_t index) const
+    {
+        return bit ? _partition[level] + _bitmatrix[level].rank(1, index) : _bitmatrix[level].rank(0, index);
+    }
+
+    inline Dynamic_waveletmatrix::element_t Dynamic_waveletmatrix::access(const position_t index) const
+    {
+        if (index <= 0 || index > _length) {
+            return invalid_value();
+        }
+        element_t  value = 0;
+        position_t i     = index - 1;
+        for (size_t level = 0; level < _depth; level++) {
+            const bool bit = _bitmatrix[level][i];
+            value = (value << 1) | bit;
+            i     = down(level, bit, i);
+        }
+
+        return value;
+    }
+
+    inline Dynamic_waveletmatrix::time_t Dynamic_waveletmatrix::rank(const element_t a, const position_t index) const
+    {
+        if (_depth < 64 && (a >> _depth) != 0) {
+            return 0;
+        }
+        position_t l = 0, r = std::min <position_t>(index, _length);
+        for (size_t level = 0; level < _depth; level++) {
+            const bool bit = bit_of(a, level);
+            l = down(level, bit, l);
+            r = down(level, bit, r);
+        }
+
+        return r - l;
+    }
+
+    inline Dynamic_waveletmatrix::position_t Dynamic_waveletmatrix::select(const element_t a, const time_t order) const
+    {
+        if (order <= 0) {
+            return 0;
+        } else if (order > rank(a, _length)) {
+            return invalid_value();
+        }
+        // 最下段でのaの先頭
+        position_t l = 0;
+        for (size_t level = 0; level < _depth; level++) {
+            l = down(level, bit_of(a, level), l);
+        }
+        // 下から上へたどる．pは0-origin
+        position_t p = l + order - 1;
+        for (size_t level = _depth; level-- > 0; ) {
+            if (bit_of(a, level)) {
+                p = _bitmatrix[level].select(1, p - _partition[level] + 1) - 1;
+            } else {
+                p = _bitmatrix[level].select(0, p + 1) - 1;
+            }
+        }
+
+        return p + 1;
+    }
+
+    inline std::vector <Dynamic_waveletmatrix::element_t> Dynamic_waveletmatrix::access(const std::vector <position_t> &indices) const
+    {
+        std::vector <element_t> result(indices.size(), invalid_value());
+        position_t              pos[batch_group];
+        element_t               value[batch_group];
+        for (size_t first = 0; first < indices.size(); first += batch_group) {
+            const size_t num = std::min(indices.size() - first, size_t(batch_group));
+            // 範囲外の位置は0番目をたどらせて，最後に捨てる．
+            for (size_t q = 0; q < num; q++) {
+                const position_t index = indices[first + q];
+                pos[q]   = (index <= 0 || index > _length) ? 0 : index - 1;
+                value[q] = 0;
+                if (_depth > 0) {
+                    _bitmatrix[0].prefetch(pos[q]);
+                }
+            }
+            for (size_t level = 0; level < _depth; level++) {
+                const bitvector::Bitvector &bits = _bitmatrix[level];
+                for (size_t q = 0; q < num; q++) {
+                    const bool bit = bits[pos[q]];
+                    value[q] = (value[q] << 1) | bit;
+                    pos[q]   = down(level, bit, pos[q]);
+                    if (level + 1 < _depth) {
+                        _bitmatrix[level + 1].prefetch(pos[q]);
+                    }
+                }
+            }
+            for (size_t q = 0; q < num; q++) {
+                const position_t index = indices[first + q];
+                if (index > 0 && index <= _length) {
+                    result[first + q] = value[q];
+                }
+            }
+        }
+
+        return result;
+    }
+
+    inline std::vector <Dynamic_waveletmatrix::time_t> Dynamic_waveletmatrix::rank(const std::vector <std::pair <element_t, position_t> > &queries) const
+    {
+        std::vector <time_t> result(queries.size(), 0);
+        position_t           l[batch_group], r[batch_group];
+        for (size_t first = 0; first < queries.size(); first += batch_group) {
+            const size_t num = std::min(queries.size() - first, size_t(batch_group));
+            for (size_t q = 0; q < num; q++) {
+                const element_t a = queries[first + q].first;
+                // 値が大きすぎれば空区間をたどらせる．
+                l[q] = 0;
+                r[q] = (_depth < 64 && (a >> _depth) != 0) ? 0 : std::min <position_t>(queries[first + q].second, _length);
+                if (_depth > 0) {
+                    _bitmatrix[0].prefetch(r[q]);
+                }
+            }
+            for (size_t level = 0; level < _depth; level++) {
+                for (size_t q = 0; q < num; q++) {
+                    const bool bit = bit_of(queries[first + q].first, level);
+                    l[q] = down(level, bit, l[q]);
+                    r[q] = down(level, bit, r[q]);
+                    if (level + 1 < _depth) {
+                        _bitmatrix[level + 1].prefetch(l[q]);
+                        _bitmatrix[level + 1].prefetch(r[q]);
+                    }
+                }
+            }
+            for (size_t q = 0; q < num; q++) {
+                result[first + q] = r[q] - l[q];
+            }
+        }
+
+        return result;
+    }
+
+    inline std::vector <Dynamic_waveletmatrix::position_t> Dynamic_waveletmatrix::select(const std::vector <std::pair <element_t, time_t> > &queries) const
+    {
+        std::vector <position_t> result(queries.size(), invalid_value());
+        position_t               l[batch_group], r[batch_group];
+        for (size_t first = 0; first < queries.size(); first += batch_group) {
+            const size_t num = std::min(queries.size() - first, size_t(batch_group));
+            // 下りはrankと同じで，最下段でのaの区間を求める．
+            for (size_t q = 0; q < num; q++) {
+                const element_t a = queries[first + q].first;
+                l[q] = 0;
+                r[q] = (_depth < 64 && (a >> _depth) != 0) ? 0 : _length;
+            }
+            for (size_t level = 0; level < _depth; level++) {
+                for (size_t q = 0; q < num; q++) {
+                    const bool bit = bit_of(queries[first + q].first, level);
+                    l[q] = down(level, bit, l[q]);
+                    r[q] = down(level, bit, r[q]);
+                    if (level + 1 < _depth) {
+                        _bitmatrix[level + 1].prefetch(l[q]);
+                        _bitmatrix[level + 1].prefetch(r[q]);
+                    }
+                }
+            }
+
+            // 上り．lを0-originの位置pとして使い，orderが範囲外のクエリはrをnumの外の印にして飛ばす．
+            for (size_t q = 0; q < num; q++) {
+                const time_t order = queries[first + q].second;
+                if (order <= 0 || order > r[q] - l[q]) {
+                    result[first + q] = (order <= 0) ? 0 : invalid_value();
+                    r[q]              = invalid_value();
+                } else {
+                    l[q] += order - 1;
+                }
+            }
+            for (size_t level = _depth; level-- > 0; ) {
+                const bitvector::Bitvector &bits = _bitmatrix[level];
+                for (size_t q = 0; q < num; q++) {
+                    if (r[q] == invalid_value()) {
+                        continue;
+                    }
+                    const element_t a = queries[first + q].first;
+                    l[q] = bit_of(a, level) ? bits.select(1, l[q] - _partition[level] + 1) - 1 : bits.select(0, l[q] + 1) - 1;
+                    if (level > 0) {
+                        const bool next_bit = bit_of(a, level - 1);
+                        _bitmatrix[level - 1].prefetch_select(next_bit, next_bit ? l[q] - _partition[level - 1] + 1 : l[q] + 1);
+                    }
+                }
+            }
+            for (size_t q = 0; q < num; q++) {
+                if (r[q] != invalid_value()) {
+                    result[first + q] = l[q] + 1;
+                }
+            }
+        }
+
+        return result;
+    }
+
+    inline Dynamic_waveletmatrix::element_t Dynamic_waveletmatrix::quantile(position_t l, position_t r, time_t k) const
+    {
+        r = std::min <position_t>(r, _length);
+        if (l >= r || k >= r - l) {
+            return invalid_value();
+        }
+        element_t value = 0;
+        for (size_t level = 0; level < _depth; level++) {
+            const position_t l0    = _bitmatrix[level].rank(0, l);
+            const position_t r0    = _bitmatrix[level].rank(0, r);
+            const time_t     zeros = r0 - l0;
+            if (k < zeros) {
+                value <<= 1;
+                l       = l0;
+                r       = r0;
+            } else {
+                value = (value << 1) | 1;
+                k    -= zeros;
+                l     = _partition[level] + (l - l0);
+                r     = _partition[level] + (r - r0);
+            }
+        }
+
+        return value;
+    }
+
+    inline Dynamic_waveletmatrix::time_t Dynamic_waveletmatrix::rank_less(position_t l, position_t r, const element_t x) const
+    {
+        r = std::min <position_t>(r, _length);
+        if (l >= r) {
+            return 0;
+        } else if (_depth < 64 && (x >> _depth) != 0) {
+            return r - l;
+        }
+        time_t retval = 0;
+        for (size_t level = 0; level < _depth; level++) {
+            const position_t l0 = _bitmatrix[level].rank(0, l);
+            const position_t r0 = _bitmatrix[level].rank(0, r);
+            if (bit_of(x, level)) {
+                // 0を下る側はすべてxより小さい
+                retval += r0 - l0;
+                l       = _partition[level] + (l - l0);
+                r       = _partition[level] + (r - r0);
+            } else {
+                l = l0;
+                r = r0;
+            }
+        }
+
+        return retval;
+    }
+
+    inline Dynamic_waveletmatrix::time_t Dynamic_waveletmatrix::range_freq(const position_t l, const position_t r, const element_t lo, const element_t hi) const
+    {
+        if (lo >= hi) {
+            return 0;
+        }
+
+        return rank_less(l, r, hi) - rank_less(l, r, lo);
+    }
+
+    inline Dynamic_waveletmatrix::element_t Dynamic_waveletmatrix::prev_value(const position_t l, const position_t r, const element_t x) const
+    {
+        const time_t k = rank_less(l, r, x);
+
+        return (k == 0) ? invalid_value() : quantile(l, r, k - 1);
+    }
+
+    inline Dynamic_waveletmatrix::element_t Dynamic_waveletmatrix::next_value(const position_t l, const position_t r, const element_t x) const
+    {
+        const position_t r_ = std::min <position_t>(r, _length);
+        if (l >= r_) {
+            return invalid_value();
+        }
+        const time_t k = rank_less(l, r_, x);
+
+        return (k == r_ - l) ? invalid_value() : quantile(l, r_, k);
+    }
+
+    inline std::vector <std::pair <Dynamic_waveletmatrix::element_t, Dynamic_waveletmatrix::time_t> > Dynamic_waveletmatrix::topk(const position_t l, position_t r, const size_t k) const
+    {
+        // 区間の広い節点から展開する．葉に着いた順に頻度が高い．
+        struct Node {
+            position_t l, r;
+            size_t     level;
+            element_t  lowest; // 節点の下にある最小の値
+            bool operator<(const Node &other) const
+            {
+                return (r - l != other.r - other.l) ? (r - l < other.r - other.l) : (lowest != other.lowest) ? (lowest > other.lowest) : (level < other.level);
+            }
+        };
+
+        std::vector <std::pair <element_t, time_t> > result;
+        r = std::min <position_t>(r, _length);
+        if (l >= r || k == 0) {
+            return result;
+        }
+        std::priority_queue <Node> queue;
+        queue.push(Node { l, r, 0, 0 });
+        while (!queue.empty() && result.size() < k) {
+            const Node node = queue.top();
+            queue.pop();
+            if (node.level == _depth) {
+                result.emplace_back(node.lowest, node.r - node.l);
+                continue;
+            }
+            const position_t l0 = _bitmatrix[node.level].rank(0, node.l);
+            const position_t r0 = _bitmatrix[node.level].rank(0, node.r);
+            if (r0 > l0) {
+                queue.push(Node { l0, r0, node.level + 1, node.lowest });
+            }
+            const position_t l1 = _partition[node.level] + (node.l - l0);
+            const position_t r1 = _partition[node.level] + (node.r - r0);
+            if (r1 > l1) {
+                queue.push(Node { l1, r1, node.level + 1, node.lowest | (element_t(1) << (_depth - 1 - node.level)) });
+            }
+        }
+
+        return result;
+    }
+
+    inline std::vector <std::tuple <Dynamic_waveletmatrix::element_t, Dynamic_waveletmatrix::time_t, Dynamic_waveletmatrix::time_t> > Dynamic_waveletmatrix::intersect(const position_t l1, const position_t r1, const position_t l2, const position_t r2) const
+    {
+        std::vector <std::tuple <element_t, time_t, time_t> > result;
+        const position_t r1_ = std::min <position_t>(r1, _length);
+        const position_t r2_ = std::min <position_t>(r2, _length);
+        if (l1 < r1_ && l2 < r2_) {
+            intersect(0, l1, r1_, l2, r2_, 0, result);
+        }
+
+        return result;
+    }
+
+    inline void Dynamic_waveletmatrix::intersect(const size_t level, const position_t l1, const position_t r1, const position_t l2, const position_t r2, const element_t value,
+                                                 std::vector <std::tuple <element_t, time_t, time_t> > &result) const
+    {
+        // 両方の区間が空でない節点だけを下る．
+        if (level == _depth) {
+            result.emplace_back(value, r1 - l1, r2 - l2);
+
+            return;
+        }
+        const bitvector::Bitvector &bits = _bitmatrix[level];
+        const position_t            a0   = bits.rank(0, l1), b0 = bits.rank(0, r1);
+        const position_t            c0   = bits.rank(0, l2), d0 = bits.rank(0, r2);
+        if (b0 > a0 && d0 > c0) {
+            intersect(level + 1, a0, b0, c0, d0, value << 1, result);
+        }
+        const position_t z = _partition[level];
+        if (r1 - l1 > b0 - a0 && r2 - l2 > d0 - c0) {
+            intersect(level + 1, z + (l1 - a0), z + (r1 - b0), z + (l2 - c0), z + (r2 - d0), (value << 1) | 1, result);
+        }
+    }
+
+    inline size_t Dynamic_waveletmatrix::depth() const
+    {
+        return _depth;
+    }
+
+    inline size_t Dynamic_waveletmatrix::size() const
+    {
+        return _length;
+    }
+
+    inline size_t Dynamic_waveletmatrix::bytes() const
+    {
+        size_t result = _partition.size() * sizeof(position_t);
+        for (const auto &bits : _bitmatrix) {
+            result += bits.bytes();
+        }
+
+        return result;
+    }
+
+    inline std::string Dynamic_waveletmatrix::to_string() const
+    {
+        std::string result = "";
+        for (position_t i = 1; i <= _length; i++) {
+            result += std::to_string(access(i)) + " ";
+        }
+
+        return result;
+    }
+
+    inline Dynamic_waveletmatrix::element_t Dynamic_waveletmatrix::invalid_value() const
+    {
+        return std::numeric_limits <element_t>::max();
+    }
+
+    inline std::string Dynamic_waveletmatrix::str() const
+    {
+        std::string result = "";
+        // 全体の長さ
+        result += "length: " + std::to_string(_length) + '\n';
+        result += "depth: " + std::to_string(_depth) + '\n';
+        // 各レベルのビット列と区切り
+        for (size_t level = 0; level < _depth; level++) {
+            result += _bitmatrix[level].to_string() + " partition: " + std::to_string(_partition[level]) + '\n';
+        }
+        result += "bytes: " + std::to_string(bytes()) + '\n';
+
+        return result;
+    }
+
+    inline std::ostream&operator<<(std::ostream &os, const Dynamic_waveletmatrix &wm)
+    {
+        os << wm.to_string();
+
+        return os;
+    }
+
+    inline std::ostream &Dynamic_waveletmatrix::write(std::ostream &os) const
+    {
+        succinct::bin::write_header(os, succinct::bin::make_header(succinct::bin::WAVELET_MATRIX, _length, _depth, sizeof(position_t)));
+        succinct::bin::write_section(os, _partition.data(), _depth * sizeof(position_t));
+        for (const auto &bits : _bitmatrix) {
+            bits.write(os);
+        }
+
+        return os;
+    }
+
+    inline std::istream &Dynamic_waveletmatrix::read(std::istream &is)
+    {
+        succinct::bin::Header header;
+        if (!succinct::bin::read_header(is, header) || !succinct::bin::check_header(header, succinct::bin::WAVELET_MATRIX, sizeof(position_t)) || header.count > 64) {
+            is.setstate(std::ios_base::failbit);
+
+            return is;
+        }
+        // 読み終わるまでは元の行列を残す．
+        std::vector <position_t> partition(header.count);
+        std::vector <bitvector::Bitvector> bitmatrix(header.count);
+        if (!succinct::bin::read_section(is, partition.data(), header.count * sizeof(position_t))) {
+            return is;
+        }
+        for (auto &bits : bitmatrix) {
+            if (!bits.read(is) || bits.size() != header.length) {
+                is.setstate(std::ios_base::failbit);
+
+                return is;
+            }
+        }
+        if (!valid_levels(header.length, partition, bitmatrix)) {
+            is.setstate(std::ios_base::failbit);
+
+            return is;
+        }
+        _length    = header.length;
+        _depth     = header.count;
+        _partition = std::move(partition);
+        _bitmatrix = std::move(bitmatrix);
+
+        return is;
+    }
+
+    inline bool Dynamic_waveletmatrix::attach(const std::shared_ptr <const Mapped_file> &file, const std::size_t offset)
+    {
+        succinct::bin::Header header;
+        if (!file || !succinct::bin::read_header(*file, offset, header) || !succinct::bin::check_header(header, succinct::bin::WAVELET_MATRIX, sizeof(position_t)) || header.count > 64) {
+            return false;
+        }
+        std::size_t next = offset + sizeof(header);
+        if (next + succinct::bin::padded(header.count * sizeof(position_t)) > file->size()) {
+            return false;
+        }
+        // 区切りはレベル数個だけなのでコピーする．
+        std::vector <position_t> partition(header.count);
+        std::memcpy(partition.data(), file->data() + next, header.count * sizeof(position_t));
+        next += succinct::bin::padded(header.count * sizeof(position_t));
+        std::vector <bitvector::Bitvector> bitmatrix(header.count);
+        for (auto &bits : bitmatrix) {
+            if (!bits.attach(file, next) || bits.size() != header.length) {
+                return false;
+            }
+            next += bits.binary_size();
+        }
+        if (!valid_levels(header.length, partition, bitmatrix)) {
+            return false;
+        }
+        _length    = header.length;
+        _depth     = header.count;
+        _partition = std::move(partition);
+        _bitmatrix = std::move(bitmatrix);
+
+        return true;
+    }
+
+    inline bool Dynamic_waveletmatrix::valid_levels(const position_t length, const std::vector <position_t> &partition, const std::vector <bitvector::Bitvector> &bitmatrix)
+    {
+        for (size_t level = 0; level < partition.size(); level++) {
+            if (partition[level] > length || partition[level] != bitmatrix[level].count(0)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    inline bool Dynamic_waveletmatrix::open(const std::string &filename)
+    {
+        const auto file = std::make_shared <Mapped_file>();
+
+        return file->open(filename) && attach(file, 0);
+    }
+
+    inline size_t Dynamic_waveletmatrix::binary_size() const
+    {
+        size_t result = sizeof(succinct::bin::Header) + succinct::bin::padded(_depth * sizeof(position_t));
+        for (const auto &bits : _bitmatrix) {
+            result += bits.binary_size();
+        }
+
+        return result;
+    }
+
+    inline void testDynamic_waveletmatrix()
+    {
+        using element_t = Dynamic_waveletmatrix::element_t;
+
+        const std::vector <element_t> small = { 5, 4, 5, 5, 2, 1, 5, 6, 1, 3, 5, 0 };
+        const Dynamic_waveletmatrix   wm(small);
+        std::cout << wm.str() << std::endl;
+        std::cout << wm << std::endl;
+        for (size_t i = 1; i <= small.size(); i++) {
+            std::cout << "rank(5, " << i << ") = " << wm.rank(5, i) << std::endl;
+        }
+        for (size_t i = 1; i <= wm.rank(5, small.size()); i++) {
+            std::cout << "select(5, " << i << ") = " << wm.select(5, i) << std::endl;
+        }
+        for (size_t k = 0; k < small.size(); k++) {
+            std::cout << "quantile(0, 12, " << k << ") = " << wm.quantile(0, 12, k) << std::endl;
+        }
+        for (const auto &vc : wm.topk(2, 11, 3)) {
+            std::cout << "topk(2, 11) : " << vc.first << " x " << vc.second << std::endl;
+        }
+        for (const auto &vcc : wm.intersect(0, 6, 6, 12)) {
+            std::cout << "intersect : " << std::get <0>(vcc) << " " << std::get <1>(vcc) << " " << std::get <2>(vcc) << std::endl;
+        }
+
+        // 素朴な走査と比べる
+        const size_t              n = 20000, sigma = 300;
+        std::vector <element_t>   array(n);
+        std::uint64_t             x = 88172645463325252ULL;
+        for (auto &a : array) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            a  = (x >> 11) % sigma;
+        }
+        const Dynamic_waveletmatrix big(array);
+        size_t                      errors = 0;
+        for (int q = 0; q < 300; q++) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            size_t          l = x % n, r = (x >> 20) % (n + 1);
+            if (l > r) {
+                std::swap(l, r);
+            }
+            const element_t lo = (x >> 40) % sigma, hi = lo + (x >> 50) % 50;
+            std::vector <element_t> sorted(array.begin() + l, array.begin() + r);
+            std::sort(sorted.begin(), sorted.end());
+            if (!sorted.empty()) {
+                const size_t k = (x >> 30) % sorted.size();
+                errors += (big.quantile(l, r, k) != sorted[k]);
+            }
+            errors += (big.range_freq(l, r, lo, hi) != size_t(std::lower_bound(sorted.begin(), sorted.end(), hi) - std::lower_bound(sorted.begin(), sorted.end(), lo)));
+            const auto prev = std::lower_bound(sorted.begin(), sorted.end(), lo);
+            errors += (big.prev_value(l, r, lo) != ((prev == sorted.begin()) ? big.invalid_value() : *(prev - 1)));
+            errors += (big.next_value(l, r, lo) != ((prev == sorted.end()) ? big.invalid_value() : *prev));
+            errors += (big.rank(lo, r) != size_t(std::count(array.begin(), array.begin() + r, lo)));
+            errors += (big.access(l + 1) != array[l]);
+
+            std::vector <size_t> freq(sigma, 0);
+            for (size_t i = l; i < r; i++) {
+                freq[array[i]]++;
+            }
+            const auto top = big.topk(l, r, 5);
+            for (size_t i = 0; i < top.size(); i++) {
+                errors += (freq[top[i].first] != top[i].second);
+                errors += (i > 0 && (top[i - 1].second < top[i].second || (top[i - 1].second == top[i].second && top[i - 1].first > top[i].first)));
+            }
+            errors += (*std::max_element(freq.begin(), freq.end()) != (top.empty() ? 0 : top[0].second));
+
+            size_t l2 = (x >> 5) % n, r2 = std::min(n, l2 + (x >> 45) % 2000);
+            std::vector <size_t> freq2(sigma, 0);
+            for (size_t i = l2; i < r2; i++) {
+                freq2[array[i]]++;
+            }
+            size_t common = 0;
+            for (const auto &vcc : big.intersect(l, r, l2, r2)) {
+                errors += (freq[std::get <0>(vcc)] != std::get <1>(vcc) || freq2[std::get <0>(vcc)] != std::get <2>(vcc));
+                common++;
+            }
+            for (size_t v = 0; v < sigma; v++) {
+                common -= (freq[v] > 0 && freq2[v] > 0);
+            }
+            errors += (common != 0);
+        }
+        for (element_t v = 0; v < sigma; v += 37) {
+            for (size_t order = 1, i = 0; i < n; i++) {
+                if (array[i] == v) {
+                    errors += (big.select(v, order++) != i + 1);
+                }
+            }
+        }
+
+        // 並列構築は逐次構築と同じ行列になる
+        std::vector <element_t> large(3 * Dynamic_waveletmatrix::build_block + 12345);
+        for (auto &a : large) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            a  = x >> 44;
+        }
+        parallel::Thread_pool       pool(3);
+        const Dynamic_waveletmatrix sequential(large), threaded(large, 0, &pool);
+        errors += (sequential.str() != threaded.str());
+        for (size_t i = 0; i < large.size(); i += 997) {
+            errors += (threaded.access(i + 1) != large[i]);
+        }
+
+        // 書き出してmmapで読み戻す
+        const std::string filename = "testDynamic_waveletmatrix.bin";
+        {
+            std::ofstream ofs(filename, std::ios::binary);
+            big.write(ofs);
+            threaded.write(ofs);
+        }
+        const auto            file = std::make_shared <Mapped_file>(filename);
+        Dynamic_waveletmatrix mapped, mapped_large;
+        errors += !mapped.attach(file, 0) || !mapped_large.attach(file, big.binary_size());
+        errors += (file->size() != big.binary_size() + threaded.binary_size());
+        errors += (mapped.str() != big.str() || mapped_large.str() != threaded.str());
+        for (size_t i = 0; i + 100 < n; i += 4999) {
+            errors += (mapped.quantile(i, i + 100, 50) != big.quantile(i, i + 100, 50));
+            errors += (mapped.select(array[i], 3) != big.select(array[i], 3));
+        }
+        std::ifstream         ifs(filename, std::ios::binary);
+        Dynamic_waveletmatrix loaded;
+        errors += !loaded.read(ifs) || (loaded.str() != big.str());
+        ifs.close();
+
+        // 壊れたファイルは読まず，元の行列を残す
+        std::string bytes;
+        {
+            std::ostringstream oss;
+            big.write(oss);
+            bytes = oss.str();
+        }
+        const size_t partition_offset = sizeof(succinct::bin::Header);
+        const size_t hint_offset      = partition_offset + succinct::bin::padded(big.depth() * sizeof(Dynamic_waveletmatrix::position_t)) +
+                                        sizeof(succinct::bin::Header) + (n / bitvector::Bitvector::line_bits + 1) * bitvector::Bitvector::line_words * sizeof(std::uint64_t);
+        const auto corrupt = [&bytes, &filename](const size_t offset, const Dynamic_waveletmatrix::position_t value) {
+                                 std::string broken = bytes;
+                                 std::memcpy(&broken[offset], &value, sizeof(value));
+                                 std::ofstream ofs(filename, std::ios::binary);
+                                 ofs.write(broken.data(), broken.size());
+
+                                 return broken;
+                             };
+        for (const auto &broken : { std::make_pair(partition_offset, Dynamic_waveletmatrix::position_t(1000000000)),
+                                    std::make_pair(partition_offset, Dynamic_waveletmatrix::position_t(1)),
+                                    std::make_pair(hint_offset, Dynamic_waveletmatrix::position_t(1000000000)) }) {
+            std::istringstream iss(corrupt(broken.first, broken.second));
+            errors += static_cast <bool>(loaded.read(iss)) || (loaded.str() != big.str());
+            errors += mapped.open(filename) || (mapped.str() != big.str());
+        }
+        std::remove(filename.c_str());
+
+        // まとめて処理しても1つずつと同じ
+        std::vector <Dynamic_waveletmatrix::position_t>                          indices;
+        std::vector <std::pair <element_t, Dynamic_waveletmatrix::position_t> > rank_queries;
+        std::vector <std::pair <element_t, Dynamic_waveletmatrix::time_t> >     select_queries;
+        for (size_t q = 0; q < 1000; q++) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            indices.push_back(x % (n + 2));
+            rank_queries.emplace_back((x >> 20) % (sigma + 10), (x >> 30) % (n + 2));
+            select_queries.emplace_back((x >> 20) % (sigma + 10), (x >> 40) % 100);
+        }
+        const auto accessed = big.access(indices);
+        const auto ranked   = big.rank(rank_queries);
+        const auto selected = big.select(select_queries);
+        for (size_t q = 0; q < indices.size(); q++) {
+            errors += (accessed[q] != big.access(indices[q]));
+            errors += (ranked[q] != big.rank(rank_queries[q].first, rank_queries[q].second));
+            errors += (selected[q] != big.select(select_queries[q].first, select_queries[q].second));
+        }
+        std::cout << "errors : " << errors << std::endl;
+    }
+}
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef DYNAMIC_WAVELETMATRIX
+#define DYNAMIC_WAVELETMATRIX
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "bitvector.hpp"
+#include "succinct_bin.hpp"
+#include "thread_pool.hpp"
+
+namespace waveletmatrix {
+    // 実行時に長さとアルファベットの大きさを決めるウェーブレット行列
+    // 各レベルのビット列をbitvector::Bitvectorで持ち，もともとの配列は持たない．
+    // access, rank, selectの位置の数え方はWaveletmatrixと同じ．
+    // 範囲クエリの区間[l, r)は先頭からの個数で表す（0-originの半開区間）．
+    // succinct::binの形式で書き出し，mmapしたファイルからコピーせずに読める．
+    class Dynamic_waveletmatrix
+    {
+    public:
+        using element_t  = std::uint64_t;
+        using position_t = std::uint64_t;
+        using time_t     = std::uint64_t;
+
+        // 構築で1タスクが受け持つ要素数．ラインの倍数にしてタスクごとに別のラインへ書き込む．
+        static constexpr position_t build_block = 1024 * bitvector::Bitvector::line_bits;
+        // まとめて処理するクエリを，この個数ずつレベルを揃えて進める．
+        static constexpr size_t batch_group = 256;
+    public:
+        Dynamic_waveletmatrix();
+        // depthは値のビット数．0のとき最大値から決める．
+        // poolを渡すと各レベルの分配をブロック単位で，ビット列の索引をレベルとブロックの両方で並列に作る．
+        Dynamic_waveletmatrix(const std::vector <element_t> &org_array, const size_t depth = 0, parallel::Thread_pool *pool = nullptr);
+
+        // (bitwise rank * 1) * matrix_depth
+        element_t access(const position_t index) const;
+
+        // (bitwise rank * 2) * matrix_depth
+        time_t rank(const element_t a, const position_t index) const;
+
+        // (bitwise rank * 2 + bitwise select * 1) * matrix_depth
+        position_t select(const element_t a, const time_t order) const;
+
+        // 独立なクエリをまとめて処理する．batch_group個ずつ全クエリを1レベル進め，
+        // そのたびに次のレベルで読むラインを先読みするので，キャッシュミスの待ちが重なる．
+        // 結果は1つずつ呼んだときと同じ．
+        std::vector <element_t> access(const std::vector <position_t> &indices) const;
+
+        // (a, index)の組ごとのrank
+        std::vector <time_t> rank(const std::vector <std::pair <element_t, position_t> > &queries) const;
+
+        // (a, order)の組ごとのselect
+        std::vector <position_t> select(const std::vector <std::pair <element_t, time_t> > &queries) const;
+
+        // [l, r)でk番目（0-origin）に小さい値．(bitwise rank * 4) * matrix_depth
+        element_t quantile(const position_t l, const position_t r, const time_t k) const;
+
+        // [l, r)で値が[lo, hi)に入る個数．(bitwise rank * 4) * matrix_depth
+        time_t range_freq(const position_t l, const position_t r, const element_t lo, const element_t hi) const;
+
+        // [l, r)でxより小さい値の個数．(bitwise rank * 2) * matrix_depth
+        time_t rank_less(const position_t l, const position_t r, const element_t x) const;
+
+        // [l, r)で頻度が高い方からk個の(値, 頻度)．同じ頻度なら値の小さい順．
+        std::vector <std::pair <element_t, time_t> > topk(const position_t l, const position_t r, const size_t k) const;
+
+        // [l, r)でxより小さい最大の値．なければinvalid_value()
+        element_t prev_value(const position_t l, const position_t r, const element_t x) const;
+
+        // [l, r)でx以上の最小の値．なければinvalid_value()
+        element_t next_value(const position_t l, const position_t r, const element_t x) const;
+
+        // [l1, r1)と[l2, r2)の両方に現れる値と，それぞれでの頻度．値の小さい順．
+        std::vector <std::tuple <element_t, time_t, time_t> > intersect(const position_t l1, const position_t r1, const position_t l2, const position_t r2) const;
+
+        size_t        depth() const;
+        size_t        size() const;
+        // 使っているバイト数
+        size_t        bytes() const;
+        std::string   to_string() const;
+        element_t     invalid_value() const;
+        std::string   str() const;
+
+        friend std::ostream&operator<<(std::ostream &os, const Dynamic_waveletmatrix &wm);
+
+        // バイナリ形式で書く．osはバイナリモードで開くこと．
+        std::ostream &write(std::ostream &os) const;
+
+        // writeで書いたものをコピーして読む．形式が合わないか，区切りとビット列が食い違えばfailbitを立て，元の行列を残す．
+        std::istream &read(std::istream &is);
+
+        // fileのoffsetにある行列を，各レベルのビット列をコピーせずに指す．読めなければfalseで，元の行列を残す．
+        bool attach(const std::shared_ptr <const Mapped_file> &file, const std::size_t offset = 0);
+
+        // ファイルをmmapして先頭の行列を指す．ページは同じファイルを開いた他のプロセスと共有される．
+        bool open(const std::string &filename);
+
+        // writeで書くバイト数（ヘッダ込み）
+        size_t        binary_size() const;
+
+    private:
+        void build(const std::vector <element_t> &org_array, parallel::Thread_pool *pool);
+
+        // 読み込んだ各レベルの区切りがそのレベルの0の数と一致し，長さを超えないか．
+        // 区切りが壊れていると下のレベルの位置がビット列の外を指す．
+        static bool valid_levels(const position_t length, const std::vector <position_t> &partition, const std::vector <bitvector::Bitvector> &bitmatrix);
+
+        // 作業配列をdepthビットが入る最小の型Wordで持って全レベルを作る．
+        template <class Word>
+        void build_levels(const std::vector <element_t> &org_array, parallel::Thread_pool *pool);
+
+        // srcをlevelのビットで0と1のバケツに安定に分けてdstに書く（基数ソートの1パス）．
+        // 最下段ではdst = nullptrとしてビット列だけを作る．
+        template <class Source, class Word>
+        void partition_level(const size_t level, const Source *src, Word *dst, parallel::Thread_pool *pool);
+
+        // 0を下る/1を下るときの次のレベルでの位置
+        position_t down(const size_t level, const bool bit, const position_t index) const;
+
+        // valueのlevelのビット
+        bool bit_of(const element_t value, const size_t level) const;
+
+        void intersect(const size_t level, const position_t l1, const position_t r1, const position_t l2, const position_t r2, const element_t value,
+                       std::vector <std::tuple <element_t, time_t, time_t> > &result) const;
+
+        size_t _length;
+        // 値のビット数 lg s
+        size_t _depth;
+        // 上位ビットから順に並べたレベルごとのビット列 O(n lg s) bits
+        std::vector <bitvector::Bitvector> _bitmatrix;
+        // 各レベルの0の数（区切り）
+        std::vector <position_t> _partition;
+    };
+
+    void testDynamic_waveletmatrix();
+}
+
+#include "detail/dynamic_waveletmatrix.hpp"
+
+#endif
@@ -0,0 +1,400 @@
+/*! @file
+    @brief Eigen::Matrix，Eigen::SparseMatrixのバイナリI/O．
+    ファイルはmmapしてコピーなしにEigen::Mapとして読める
+    @author templateaholic10
+*/
+#ifndef EIGEN_BIN_HPP
+#define EIGEN_BIN_HPP
+
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <bin_container>
+
+/*! @brief バイナリ形式．
+    入れ物はbin_containerと同じで，[ヘッダ64バイト][セクション]...の各セクションを64バイト境界まで詰める．
+    DENSE: 値(列優先，rows*cols)
+    CSC: 外側インデックス(cols+1) | 内側インデックス(nnz) | 値(nnz)
+    複数の行列を1つのファイルに続けて書いても，それぞれの先頭は64バイト境界に揃う
+*/
+namespace Eigen {
+    namespace bin {
+        enum Kind : std::uint32_t
+        {
+            DENSE = 0,
+            CSC   = 1,
+        };
+
+        constexpr std::uint32_t version = 1;
+
+        // 入れ物の読み書きはsuccinctのバイナリ形式と共有する
+        using ::bin_container::byte_order;
+        using ::bin_container::alignment;
+        using ::bin_container::padded;
+        using ::bin_container::write_header;
+        using ::bin_container::read_header;
+        using ::bin_container::write_section;
+        using ::bin_container::read_section;
+
+        /*! @brief 要素型の識別子
+        */
+        template <typename T>
+        struct scalar_code;
+
+        template <>
+        struct scalar_code <float> { static constexpr std::uint32_t value = 1; };
+
+        template <>
+        struct scalar_code <double> { static constexpr std::uint32_t value = 2; };
+
+        template <>
+        struct scalar_code <std::complex <float> > { static constexpr std::uint32_t value = 3; };
+
+        template <>
+        struct scalar_code <std::complex <double> > { static constexpr std::uint32_t value = 4; };
+
+        template <>
+        struct scalar_code <int> { static constexpr std::uint32_t value = 5; };
+
+        template <>
+        struct scalar_code <long> { static constexpr std::uint32_t value = 6; };
+
+        struct Header {
+            char          magic[4];
+            std::uint32_t version;
+            std::uint32_t byte_order;
+            std::uint32_t kind;
+            std::uint32_t scalar;
+            std::uint32_t scalar_size;
+            std::uint32_t index_size;
+            std::uint32_t reserved0;
+            std::uint64_t rows;
+            std::uint64_t cols;
+            std::uint64_t nnz;
+            std::uint64_t reserved;
+        };
+        static_assert(sizeof(Header) == alignment, "Header must fill one alignment unit");
+
+        template <typename Elem, typename Index>
+        Header make_header(const Kind kind, const std::uint64_t rows, const std::uint64_t cols, const std::uint64_t nnz)
+        {
+            Header header;
+            std::memset(&header, 0, sizeof(header));
+            std::memcpy(header.magic, "EBIN", 4);
+            header.version     = version;
+            header.byte_order  = byte_order;
+            header.kind        = kind;
+            header.scalar      = scalar_code <Elem>::value;
+            header.scalar_size = sizeof(Elem);
+            header.index_size  = sizeof(Index);
+            header.rows        = rows;
+            header.cols        = cols;
+            header.nnz         = nnz;
+
+            return header;
+        }
+
+        /*! @brief ヘッダが期待する型と一致するか
+        */
+        template <typename Elem, typename Index>
+        bool check_header(const Header &header, const Kind kind)
+        {
+            return std::memcmp(header.magic, "EBIN", 4) == 0 && header.version == version && header.byte_order == byte_order &&
+                   header.kind == kind && header.scalar == scalar_code <Elem>::value && header.scalar_size == sizeof(Elem) && header.index_size == sizeof(Index);
+        }
+
+        /*! @brief 行列1つ分のバイト数(ヘッダ込み)
+        */
+        inline std::size_t record_size(const Header &header)
+        {
+            if (header.kind == DENSE) {
+                return sizeof(Header) + padded(header.rows*header.cols*header.scalar_size);
+            } else {
+                return sizeof(Header) + padded((header.cols + 1)*header.index_size) + padded(header.nnz*header.index_size) + padded(header.nnz*header.scalar_size);
+            }
+        }
+
+        /*! @brief 行列1つ分がavailableバイトに収まるか．壊れたヘッダで掛け算があふれないように割って比べる
+        */
+        inline bool record_fits(const Header &header, const std::size_t available)
+        {
+            if (header.kind == DENSE) {
+                if (header.cols != 0 && header.rows > available / header.cols / header.scalar_size) {
+                    return false;
+                }
+            } else if (header.cols >= available / header.index_size || header.nnz > available / std::max(header.index_size, header.scalar_size)) {
+                return false;
+            }
+
+            return record_size(header) <= available;
+        }
+
+        /*! @brief 列優先に並べ替えた行列型．ベクトルはどちらでも同じ並びなのでそのまま
+        */
+        template <typename Elem, int m, int n, int Options>
+        struct colmajor {
+            static constexpr bool convert = (Options & Eigen::RowMajor) && m != 1 && n != 1;
+            using type = Eigen::Matrix <Elem, m, n, convert ? (Options & ~Eigen::RowMajor) : Options>;
+        };
+
+        /*! @brief CSCのインデックスが壊れていないか．
+            外側インデックスが0からnnzまで単調に増え，内側インデックスがすべてrows未満であること
+        */
+        template <typename Index>
+        bool valid_csc(const Index *outer, const Index *inner, const std::uint64_t rows, const std::uint64_t cols, const std::uint64_t nnz)
+        {
+            if (rows > static_cast <std::uint64_t>(std::numeric_limits <Index>::max()) ||
+                cols > static_cast <std::uint64_t>(std::numeric_limits <Index>::max()) ||
+                nnz > static_cast <std::uint64_t>(std::numeric_limits <Index>::max()) ||
+                outer[0] != 0 || static_cast <std::uint64_t>(outer[cols]) != nnz) {
+                return false;
+            }
+            for (std::uint64_t j = 0; j < cols; j++) {
+                if (outer[j] > outer[j + 1]) {
+                    return false;
+                }
+            }
+            for (std::uint64_t k = 0; k < nnz; k++) {
+                if (inner[k] < 0 || static_cast <std::uint64_t>(inner[k]) >= rows) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    }
+}
+
+// 演算子をすべての名前空間から探索するため，グローバルにおく
+
+/*! @brief Eigen::Matrixのバイナリ抽出関数
+    @param os 出力ストリーム．バイナリモードで開くこと
+    @param M 行列
+*/
+template <typename Elem, int m, int n, int Options>
+std::ostream &out_binary(std::ostream &os, const Eigen::Matrix <Elem, m, n, Options> &M)
+{
+    const Eigen::bin::Header header = Eigen::bin::make_header <Elem, int>(Eigen::bin::DENSE, M.rows(), M.cols(), M.size());
+    Eigen::bin::write_header(os, header);
+    if (Eigen::bin::colmajor <Elem, m, n, Options>::convert) {
+        const typename Eigen::bin::colmajor <Elem, m, n, Options>::type C(M);
+        Eigen::bin::write_section(os, C.data(), sizeof(Elem)*C.size());
+    } else {
+        Eigen::bin::write_section(os, M.data(), sizeof(Elem)*M.size());
+    }
+
+    return os;
+}
+
+/*! @brief Eigen::SparseMatrix(CSC)のバイナリ抽出関数
+    @param os 出力ストリーム．バイナリモードで開くこと
+    @param M 疎行列．圧縮形式でなければ圧縮したコピーを書く
+*/
+template <typename Elem>
+std::ostream &out_binary(std::ostream &os, const Eigen::SparseMatrix <Elem> &M)
+{
+    using Index = typename Eigen::SparseMatrix <Elem>::StorageIndex;
+    if (!M.isCompressed()) {
+        Eigen::SparseMatrix <Elem> C(M);
+        C.makeCompressed();
+
+        return out_binary(os, C);
+    }
+    const Eigen::bin::Header header = Eigen::bin::make_header <Elem, Index>(Eigen::bin::CSC, M.rows(), M.cols(), M.nonZeros());
+    Eigen::bin::write_header(os, header);
+    Eigen::bin::write_section(os, M.outerIndexPtr(), sizeof(Index)*(M.cols() + 1));
+    Eigen::bin::write_section(os, M.innerIndexPtr(), sizeof(Index)*M.nonZeros());
+    Eigen::bin::write_section(os, M.valuePtr(), sizeof(Elem)*M.nonZeros());
+
+    return os;
+}
+
+/*! @brief Eigen::Matrixのバイナリ挿入関数．形が合わない場合はfailbitを立てる．Eigen::Dynamic行列はリサイズする
+    @param is 入力ストリーム．バイナリモードで開くこと
+    @param M 行列
+*/
+template <typename Elem, int m, int n, int Options>
+std::istream &in_binary(std::istream &is, Eigen::Matrix <Elem, m, n, Options> &M)
+{
+    Eigen::bin::Header header;
+    if (!Eigen::bin::read_header(is, header) || !Eigen::bin::check_header <Elem, int>(header, Eigen::bin::DENSE) ||
+        (m != Eigen::Dynamic && static_cast <std::uint64_t>(m) != header.rows) || (n != Eigen::Dynamic && static_cast <std::uint64_t>(n) != header.cols)) {
+        is.setstate(std::ios_base::failbit);
+
+        return is;
+    }
+    if (Eigen::bin::colmajor <Elem, m, n, Options>::convert) {
+        typename Eigen::bin::colmajor <Elem, m, n, Options>::type C(header.rows, header.cols);
+        Eigen::bin::read_section(is, C.data(), sizeof(Elem)*C.size());
+        M = C;
+    } else {
+        M.resize(header.rows, header.cols);
+        Eigen::bin::read_section(is, M.data(), sizeof(Elem)*M.size());
+    }
+
+    return is;
+}
+
+/*! @brief Eigen::SparseMatrixのバイナリ挿入関数．型が合わないか，インデックスが壊れていればfailbitを立てて空にする
+    @param is 入力ストリーム．バイナリモードで開くこと
+    @param M 疎行列．リサイズされる
+*/
+template <typename Elem>
+std::istream &in_binary(std::istream &is, Eigen::SparseMatrix <Elem> &M)
+{
+    using Index = typename Eigen::SparseMatrix <Elem>::StorageIndex;
+    Eigen::bin::Header header;
+    if (!Eigen::bin::read_header(is, header) || !Eigen::bin::check_header <Elem, Index>(header, Eigen::bin::CSC)) {
+        is.setstate(std::ios_base::failbit);
+
+        return is;
+    }
+    M.resize(header.rows, header.cols);
+    M.resizeNonZeros(header.nnz);
+    Eigen::bin::read_section(is, M.outerIndexPtr(), sizeof(Index)*(header.cols + 1));
+    Eigen::bin::read_section(is, M.innerIndexPtr(), sizeof(Index)*header.nnz);
+    Eigen::bin::read_section(is, M.valuePtr(), sizeof(Elem)*header.nnz);
+    if (!is || !Eigen::bin::valid_csc(M.outerIndexPtr(), M.innerIndexPtr(), header.rows, header.cols, header.nnz)) {
+        is.setstate(std::ios_base::failbit);
+        M.resize(0, 0);
+        M.data().clear();
+    }
+
+    return is;
+}
+
+/*! @class
+    @brief mmapしたバイナリファイル中の密行列．matrix()はファイルのページを直接指す
+    @tparam Elem 要素型
+*/
+template <typename Elem>
+class Mapped_matrix {
+public:
+    using M_type   = Eigen::Matrix <Elem, Eigen::Dynamic, Eigen::Dynamic>;
+    using Map_type = Eigen::Map <const M_type, Eigen::Aligned64>;
+private:
+    Mapped_file _file;
+    const Elem *_data;
+    Eigen::Index _rows;
+    Eigen::Index _cols;
+    std::size_t _next;
+public:
+    Mapped_matrix()
+        : _data(nullptr), _rows(0), _cols(0), _next(0)
+    {
+    }
+
+    /*! @brief ファイルを開く
+        @param offset 行列の先頭位置．複数の行列を並べたファイルではnext_offset()を渡していく
+        @return 成功したか
+    */
+    bool open(const std::string &filename, const std::size_t offset=0)
+    {
+        return _file.open(filename) && attach(offset);
+    }
+
+    /*! @brief 開いているファイルの別の位置にある行列に切り替える
+        @param offset 64バイト境界に揃っていなければfalse
+    */
+    bool attach(const std::size_t offset)
+    {
+        Eigen::bin::Header header;
+        if (!Eigen::bin::read_header(_file, offset, header) || !Eigen::bin::check_header <Elem, int>(header, Eigen::bin::DENSE) || !Eigen::bin::record_fits(header, _file.size() - offset)) {
+            return false;
+        }
+        _data = reinterpret_cast <const Elem *>(_file.data() + offset + sizeof(header));
+        _rows = header.rows;
+        _cols = header.cols;
+        _next = offset + Eigen::bin::record_size(header);
+
+        return true;
+    }
+
+    Map_type matrix() const
+    {
+        return Map_type(_data, _rows, _cols);
+    }
+
+    std::size_t next_offset() const
+    {
+        return _next;
+    }
+};
+
+/*! @class
+    @brief mmapしたバイナリファイル中のCSC疎行列．matrix()はファイルのページを直接指す
+    @tparam Elem 要素型
+*/
+template <typename Elem>
+class Mapped_sparse {
+public:
+    using SM_type  = Eigen::SparseMatrix <Elem>;
+    using Index    = typename SM_type::StorageIndex;
+    using Map_type = Eigen::Map <const SM_type>;
+private:
+    Mapped_file _file;
+    const Index *_outer;
+    const Index *_inner;
+    const Elem *_values;
+    Eigen::Index _rows;
+    Eigen::Index _cols;
+    Eigen::Index _nnz;
+    std::size_t _next;
+public:
+    Mapped_sparse()
+        : _outer(nullptr), _inner(nullptr), _values(nullptr), _rows(0), _cols(0), _nnz(0), _next(0)
+    {
+    }
+
+    bool open(const std::string &filename, const std::size_t offset=0)
+    {
+        return _file.open(filename) && attach(offset);
+    }
+
+    /*! @brief 開いているファイルの別の位置にある行列に切り替える．
+        インデックスが壊れていればfalseで，元の行列を指したままにする
+        @param offset 64バイト境界に揃っていなければfalse
+    */
+    bool attach(const std::size_t offset)
+    {
+        Eigen::bin::Header header;
+        if (!Eigen::bin::read_header(_file, offset, header) || !Eigen::bin::check_header <Elem, Index>(header, Eigen::bin::CSC) || !Eigen::bin::record_fits(header, _file.size() - offset)) {
+            return false;
+        }
+        const unsigned char *p     = _file.data() + offset + sizeof(header);
+        const Index         *outer = reinterpret_cast <const Index *>(p);
+        p += Eigen::bin::padded(sizeof(Index)*(header.cols + 1));
+        const Index         *inner = reinterpret_cast <const Index *>(p);
+        p += Eigen::bin::padded(sizeof(Index)*header.nnz);
+        if (!Eigen::bin::valid_csc(outer, inner, header.rows, header.cols, header.nnz)) {
+            return false;
+        }
+        _outer  = outer;
+        _inner  = inner;
+        _values = reinterpret_cast <const Elem *>(p);
+        _rows   = header.rows;
+        _cols   = header.cols;
+        _nnz    = header.nnz;
+        _next   = offset + Eigen::bin::record_size(header);
+
+        return true;
+    }
+
+    Map_type matrix() const
+    {
+        return Map_type(_rows, _cols, _nnz, _outer, _inner, _values);
+    }
+
+    std::size_t next_offset() const
+    {
+        return _next;
+    }
+};
+
+#endif
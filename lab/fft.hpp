@@ -14,8 +14,271 @@
 #include <unsupported/Eigen/FFT>
 #include <algorithm>
 #include <functional>
+#include <memory>
+#include <unordered_map>
+#include <thread_pool>
+#include <fft_codelet>
 
 namespace Eigen {
+    /*! @brief FFTの方向
+    */
+    enum class FFT_DIRECTION { FORWARD, INVERSE };
+
+    /*! @class
+        @brief FFTの計画．長さ，スカラ型，方向を固定し，回転因子と作業領域を使い回す
+        @tparam Scalar 実数型
+        @tparam Direction 変換の方向
+        同じ長さの系列を多数変換するとき，呼び出しごとの計画の構築とバッファの確保をなくす．
+        逆変換は1/nでスケーリングする（Eigen::FFTと同じ）．
+        作業領域を持つのでスレッド間で共有しない．スレッドごとの計画はfft_planで得る
+    */
+    template <typename Scalar, FFT_DIRECTION Direction>
+    class FFT_plan {
+    public:
+        using complex_type = std::complex <Scalar>;
+    private:
+        const size_t                _n;
+        Eigen::FFT <Scalar>         _fft;
+        std::vector <complex_type> _in;  // 入力の複素化，その場変換の退避用
+        std::vector <complex_type> _out; // 実数型で出力するときの複素数の結果
+    public:
+        /*! @param n 系列の長さ
+        */
+        explicit FFT_plan(const size_t n)
+            : _n(n), _in(n), _out(n)
+        {
+            // ここで回転因子を作らせておく
+            if (n > 0) {
+                execute(_in.data());
+            }
+        }
+
+        FFT_plan(const FFT_plan&)           = delete;
+        FFT_plan&operator=(const FFT_plan&) = delete;
+
+        size_t size() const
+        {
+            return _n;
+        }
+
+        /*! @brief 長さsize()の系列inを変換してoutに書く．outはinと重なってもよい
+            @tparam From 実数型または複素数型
+            @tparam To 実数型または複素数型．実数型のときは結果の実部を書く
+        */
+        template <typename From, typename To>
+        void execute(const From *in, To *out)
+        {
+            if (static_cast <const void *>(in) == static_cast <const void *>(out)) {
+                // Eigen::FFTはその場変換できないので退避する
+                std::copy(in, in + _n, _in.begin());
+                transform(static_cast <const complex_type *>(_in.data()), out);
+            } else {
+                transform(in, out);
+            }
+        }
+
+        /*! @brief 長さsize()の複素系列をその場で変換する
+        */
+        void execute(complex_type *data)
+        {
+            execute(static_cast <const complex_type *>(data), data);
+        }
+
+    private:
+        // 複素→複素
+        void transform(const complex_type *in, complex_type *out)
+        {
+            if (Direction == FFT_DIRECTION::FORWARD) {
+                _fft.fwd(out, in, _n);
+            } else {
+                _fft.inv(out, in, _n);
+            }
+        }
+
+        // 複素→実数．逆変換では実数出力のEigen::FFTを使う
+        void transform(const complex_type *in, Scalar *out)
+        {
+            if (Direction == FFT_DIRECTION::FORWARD) {
+                _fft.fwd(_out.data(), in, _n);
+                std::transform(_out.begin(), _out.end(), out, [](const complex_type &c){return std::real(c);});
+            } else {
+                _fft.inv(out, in, _n);
+            }
+        }
+
+        // 実数→複素．順変換では実数入力のEigen::FFTを使う
+        void transform(const Scalar *in, complex_type *out)
+        {
+            if (Direction == FFT_DIRECTION::FORWARD) {
+                _fft.fwd(out, in, _n);
+            } else {
+                std::copy(in, in + _n, _in.begin());
+                _fft.inv(out, _in.data(), _n);
+            }
+        }
+
+        // 実数→実数
+        void transform(const Scalar *in, Scalar *out)
+        {
+            if (Direction == FFT_DIRECTION::FORWARD) {
+                _fft.fwd(_out.data(), in, _n);
+                std::transform(_out.begin(), _out.end(), out, [](const complex_type &c){return std::real(c);});
+            } else {
+                std::copy(in, in + _n, _in.begin());
+                _fft.inv(out, _in.data(), _n);
+            }
+        }
+    };
+
+    /*! @brief スレッドごとに長さをキーとしてキャッシュした計画を返す
+        @tparam Plan 長さを引数にとるコンストラクタを持つ計画型
+        @param n 系列の長さ
+        同じスレッドで同じ(Plan, n)について呼ぶと同じ計画が返る
+    */
+    template <typename Plan>
+    Plan&cached_plan(const size_t n)
+    {
+        thread_local std::unordered_map <size_t, std::unique_ptr <Plan> > plans;
+        std::unique_ptr <Plan> &plan = plans[n];
+        if (!plan) {
+            plan.reset(new Plan(n));
+        }
+
+        return *plan;
+    }
+
+    /*! @brief (n, Scalar, Direction)のFFTの計画
+    */
+    template <typename Scalar, FFT_DIRECTION Direction>
+    FFT_plan <Scalar, Direction>&fft_plan(const size_t n)
+    {
+        return cached_plan <FFT_plan <Scalar, Direction> >(n);
+    }
+
+    /*! @brief 長さNがコンパイル時に分かるときのFFT．codeletがある長さ（2の冪で32以下，FFT_USE_CODELETを定義すれば64以下の多く）ではそれを使う．それ以外は計画を使う
+        @tparam Scalar 実数型
+        @tparam Direction 変換の方向
+        @tparam N 系列の長さ
+        outはinと重なってもよい
+    */
+    template <typename Scalar, FFT_DIRECTION Direction, size_t N, typename From, typename To, typename std::enable_if <!codelet::is_available <N>::value>::type * = nullptr>
+    void fixed_fft(const From *in, To *out)
+    {
+        fft_plan <Scalar, Direction>(N).execute(in, out);
+    }
+
+    template <typename Scalar, FFT_DIRECTION Direction, size_t N, typename From, typename std::enable_if <codelet::is_available <N>::value>::type * = nullptr>
+    void fixed_fft(const From *in, std::complex <Scalar> *out)
+    {
+        constexpr int Sign = (Direction == FFT_DIRECTION::FORWARD) ? -1 : 1;
+        using Codelet = codelet::Selected <Scalar, Sign, N>;
+        if (static_cast <const void *>(in) == static_cast <const void *>(out)) {
+            std::array <std::complex <Scalar>, N> buffer;
+            Codelet::run(in, 1, buffer.data());
+            std::copy(buffer.begin(), buffer.end(), out);
+        } else {
+            Codelet::run(in, 1, out);
+        }
+        if (Direction == FFT_DIRECTION::INVERSE) {
+            const Scalar scale = Scalar(1.) / N;
+            for (size_t k = 0; k < N; k++) {
+                out[k] *= scale;
+            }
+        }
+    }
+
+    /*! @brief 実数型で出力するとき．順変換は結果の実部を書く．
+        逆変換は計画（Eigen::FFTの実数出力）と同じく前半in[0, N / 2]だけを読み，
+        エルミート対称に延ばしたスペクトルを変換する
+    */
+    template <typename Scalar, FFT_DIRECTION Direction, size_t N, typename From, typename std::enable_if <codelet::is_available <N>::value>::type * = nullptr>
+    void fixed_fft(const From *in, Scalar *out)
+    {
+        std::array <std::complex <Scalar>, N> buffer;
+        if (Direction == FFT_DIRECTION::INVERSE) {
+            for (size_t k = 0; k <= N / 2; k++) {
+                buffer[k] = in[k];
+            }
+            for (size_t k = 1; k < N - k; k++) {
+                buffer[N - k] = std::conj(buffer[k]);
+            }
+            fixed_fft <Scalar, Direction, N>(buffer.data(), buffer.data());
+        } else {
+            fixed_fft <Scalar, Direction, N>(in, buffer.data());
+        }
+        for (size_t k = 0; k < N; k++) {
+            out[k] = std::real(buffer[k]);
+        }
+    }
+
+    /*! @brief 等間隔に並んだcount本の系列をまとめて変換する
+        @param get_plan 長さから計画への参照を返す関数（fft_planなど）．スレッドごとに呼ぶ
+        @param length 系列の長さ
+        @param count 系列の本数
+        @param in 入力．系列sの時刻tはin[s * in_dist + t * in_stride]
+        @param out 出力．系列sの時刻tはout[s * out_dist + t * out_stride]
+        @param threads スレッド数
+        時間方向に連続な系列はそのまま計画に渡す．
+        飛び飛びの系列はbatch_block本ずつ作業領域に集めてから変換するので，
+        系列方向に連続な行列（列優先で時間方向横など）でもキャッシュ行単位で読み書きする
+    */
+    constexpr std::ptrdiff_t batch_block = 16;
+
+    template <typename GetPlan, typename From, typename To>
+    void batch_transform(const GetPlan &get_plan, const size_t length, const size_t count,
+                         const From *in, const std::ptrdiff_t in_stride, const std::ptrdiff_t in_dist,
+                         To *out, const std::ptrdiff_t out_stride, const std::ptrdiff_t out_dist,
+                         const size_t threads = 1)
+    {
+        const std::ptrdiff_t n    = length;
+        const auto           work = [&](const std::ptrdiff_t first, const std::ptrdiff_t last) {
+                                        auto                &plan = get_plan(length);
+                                        std::vector <From>  gathered(in_stride == 1 ? 0 : batch_block * n);
+                                        std::vector <To>    scattered(out_stride == 1 ? 0 : batch_block * n);
+                                        for (std::ptrdiff_t begin = first; begin < last; begin += batch_block) {
+                                            const std::ptrdiff_t end = std::min(begin + batch_block, last);
+                                            if (in_stride != 1) {
+                                                for (std::ptrdiff_t t = 0; t < n; t++) {
+                                                    for (std::ptrdiff_t s = begin; s < end; s++) {
+                                                        gathered[(s - begin) * n + t] = in[s * in_dist + t * in_stride];
+                                                    }
+                                                }
+                                            }
+                                            for (std::ptrdiff_t s = begin; s < end; s++) {
+                                                const From *src = (in_stride == 1) ? in + s * in_dist : gathered.data() + (s - begin) * n;
+                                                To         *dst = (out_stride == 1) ? out + s * out_dist : scattered.data() + (s - begin) * n;
+                                                plan.execute(src, dst);
+                                            }
+                                            if (out_stride != 1) {
+                                                for (std::ptrdiff_t t = 0; t < n; t++) {
+                                                    for (std::ptrdiff_t s = begin; s < end; s++) {
+                                                        out[s * out_dist + t * out_stride] = scattered[(s - begin) * n + t];
+                                                    }
+                                                }
+                                            }
+                                        }
+                                    };
+        if (threads > 1 && count > static_cast <size_t>(batch_block)) {
+            parallel::Thread_pool pool(threads - 1);
+            pool.parallel_for(0, count, work, batch_block);
+        } else {
+            work(0, count);
+        }
+    }
+
+    /*! @brief 行列の各系列をまとめて変換する
+        @param option 時間方向の縦横．Eigen::ColMajorのとき時間方向は縦で，各列が1本の系列
+    */
+    template <typename GetPlan, typename From, int Rows, int Cols, typename To>
+    void batch_transform(const GetPlan &get_plan, const Eigen::Matrix <From, Rows, Cols> &X, Eigen::Matrix <To, Rows, Cols> &Y, const int option, const size_t threads)
+    {
+        if (option == Eigen::ColMajor) {
+            batch_transform(get_plan, X.rows(), X.cols(), X.data(), X.rowStride(), X.colStride(), Y.data(), Y.rowStride(), Y.colStride(), threads);
+        } else {
+            batch_transform(get_plan, X.cols(), X.rows(), X.data(), X.colStride(), X.rowStride(), Y.data(), Y.colStride(), Y.rowStride(), threads);
+        }
+    }
+
     /*! @brief 1変量時系列のFFT．
         @tparam To 実数型または複素数型
         指定しないと複素数型になる
@@ -34,8 +297,7 @@ namespace Eigen {
     {
         using result_type = std::array <To, N>;
         result_type retval;
-        Eigen::FFT <typename std::decomplexify <To>::type> fft;
-        fft.fwd(retval.data(), x.data(), N);
+        fixed_fft <typename std::decomplexify <To>::type, FFT_DIRECTION::FORWARD, N>(x.data(), retval.data());
 
         return retval;
     }
@@ -53,28 +315,56 @@ namespace Eigen {
     template <typename To, typename From, size_t N, typename std::enable_if <!std::is_same <To, typename std::complexify <To>::type>::value>::type * = nullptr>
     std::array <To, N> fft(const std::array <From, N> &x)
     {
-        using tmp_type = std::array <typename std::complexify <To>::type, N>;
-        tmp_type tmp(fft<typename std::complexify <To>::type>(x));
         using result_type = std::array <To, N>;
         result_type retval;
-        std::transform(tmp.begin(), tmp.end(), retval.begin(), [](const typename std::complexify <To>::type &c){return std::real(c);});
+        fixed_fft <To, FFT_DIRECTION::FORWARD, N>(x.data(), retval.data());
 
         return retval;
     }
 
+    /*! @brief 出力先を指定する場合．確保をしない
+    */
+    template <typename To, typename From, size_t N>
+    void fft(const std::array <From, N> &x, std::array <To, N> &X)
+    {
+        fixed_fft <typename std::decomplexify <To>::type, FFT_DIRECTION::FORWARD, N>(x.data(), X.data());
+    }
+
     /*! @brief std::vector用
     */
     template <typename T>
     std::vector <typename std::complexify <T>::type> fft(const std::vector <T> &x)
     {
         using result_type = std::vector <typename std::complexify <T>::type>;
-        result_type                                       retval;
-        Eigen::FFT <typename std::decomplexify <T>::type> fft;
-        fft.fwd(retval, x);
+        result_type                                       retval(x.size());
+        fft_plan <typename std::decomplexify <T>::type, FFT_DIRECTION::FORWARD>(x.size()).execute(x.data(), retval.data());
 
         return retval;
     }
 
+    /*! @brief 出力先を指定する場合．Xの大きさが合っていれば確保をしない
+    */
+    template <typename To, typename From>
+    void fft(const std::vector <From> &x, std::vector <To> &X)
+    {
+        X.resize(x.size());
+        fft_plan <typename std::decomplexify <To>::type, FFT_DIRECTION::FORWARD>(x.size()).execute(x.data(), X.data());
+    }
+
+    /*! @brief 複素系列をその場でFFTする
+    */
+    template <typename Complex, typename std::enable_if <std::is_complex <Complex>::value>::type * = nullptr>
+    void fft_inplace(std::vector <Complex> &x)
+    {
+        fft_plan <typename std::decomplexify <Complex>::type, FFT_DIRECTION::FORWARD>(x.size()).execute(x.data());
+    }
+
+    template <typename Complex, size_t N, typename std::enable_if <std::is_complex <Complex>::value>::type * = nullptr>
+    void fft_inplace(std::array <Complex, N> &x)
+    {
+        fixed_fft <typename std::decomplexify <Complex>::type, FFT_DIRECTION::FORWARD, N>(x.data(), x.data());
+    }
+
     /*! @brief 多変量時系列のFFT．
         @tparam To 実数型または複素数型
         指定しないと複素数型になる
@@ -83,32 +373,17 @@ namespace Eigen {
         @tparam Cols 列数
         @param X データ行列
         @param option 時間方向の縦横．デフォルト値はEigen::ColMajorでこのとき時間方向は縦
+        @param threads スレッド数．系列を分担する
     */
 
-    /*! @brief Eigen::Matrix用
+    /*! @brief Eigen::Matrix用．全系列をbatch_transformでまとめて変換する
     */
-
-    // TODO: 時間方向横のときfftがうまくいかない
-
-    /*! @brief fft<std::complex<double>>の場合を担保
-    */
-    template <typename To, typename From, int Rows, int Cols, typename std::enable_if <std::is_same <To, typename std::complexify <To>::type>::value>::type * = nullptr>
-    Eigen::Matrix <To, Rows, Cols> fft(const Eigen::Matrix <From, Rows, Cols> &X, const int option = Eigen::ColMajor)
+    template <typename To, typename From, int Rows, int Cols>
+    Eigen::Matrix <To, Rows, Cols> fft(const Eigen::Matrix <From, Rows, Cols> &X, const int option = Eigen::ColMajor, const size_t threads = 1)
     {
-        const int                                         rows = X.rows();
-        const int                                         cols = X.cols();
         using result_type = Eigen::Matrix <To, Rows, Cols>;
-        result_type                                       retval(rows, cols);
-        Eigen::FFT <typename std::decomplexify <To>::type> fft;
-        if (option == Eigen::ColMajor) {
-            for (int j = 0; j < cols; j++) {
-                retval.col(j) = fft.fwd(X.col(j).eval());
-            }
-        } else {
-            for (int i = 0; i < rows; i++) {
-                retval.row(i) = fft.fwd(X.row(i).eval());
-            }
-        }
+        result_type retval(X.rows(), X.cols());
+        batch_transform(fft_plan <typename std::decomplexify <To>::type, FFT_DIRECTION::FORWARD>, X, retval, option, threads);
 
         return retval;
     }
@@ -116,17 +391,9 @@ namespace Eigen {
     /*! @brief 型指定しない場合を担保
     */
     template <int Rows, int Cols, typename From>
-    Eigen::Matrix <typename std::complexify <From>::type, Rows, Cols> fft(const Eigen::Matrix <From, Rows, Cols> &X, const int option = Eigen::ColMajor)
+    Eigen::Matrix <typename std::complexify <From>::type, Rows, Cols> fft(const Eigen::Matrix <From, Rows, Cols> &X, const int option = Eigen::ColMajor, const size_t threads = 1)
     {
-        return fft<typename std::complexify<From>::type>(X, option);
-    }
-
-    /*! @brief fft<double>の場合を担保
-    */
-    template <typename To, typename From, int Rows, int Cols, typename std::enable_if <!std::is_same <To, typename std::complexify <To>::type>::value>::type * = nullptr>
-    Eigen::Matrix <To, Rows, Cols> fft(const Eigen::Matrix <From, Rows, Cols> &X, const int option = Eigen::ColMajor)
-    {
-        return fft<typename std::complexify<To>::type>(X, option).real();
+        return fft<typename std::complexify<From>::type>(X, option, threads);
     }
 
     /*! @brief 1変量周波数系列の逆FFT
@@ -147,8 +414,7 @@ namespace Eigen {
     {
         using result_type = std::array <To, N>;
         result_type                                          retval;
-        Eigen::FFT <typename std::decomplexify <From>::type> fft;
-        fft.inv(retval.data(), X.data(), N);
+        fixed_fft <typename std::decomplexify <From>::type, FFT_DIRECTION::INVERSE, N>(X.data(), retval.data());
 
         return retval;
     }
@@ -158,13 +424,19 @@ namespace Eigen {
     template <typename To, typename From, size_t N, typename std::enable_if <!std::is_same <From, typename std::complexify <From>::type>::value>::type * = nullptr>
     std::array <To, N> ifft(const std::array <From, N> &X)
     {
-        using tmp_type = std::array <typename std::complexify <From>::type, N>;
-        tmp_type tmp;
-        for (size_t i = 0; i < N; i++) {
-            tmp[i].real(X[i]);
-            tmp[i].imag(0.);
-        }
-        return ifft<To>(tmp);
+        using result_type = std::array <To, N>;
+        result_type retval;
+        fixed_fft <From, FFT_DIRECTION::INVERSE, N>(X.data(), retval.data());
+
+        return retval;
+    }
+
+    /*! @brief 出力先を指定する場合．確保をしない
+    */
+    template <typename To, typename From, size_t N>
+    void ifft(const std::array <From, N> &X, std::array <To, N> &x)
+    {
+        fixed_fft <typename std::decomplexify <From>::type, FFT_DIRECTION::INVERSE, N>(X.data(), x.data());
     }
 
     /*! @brief 値域が指定されていない場合を担保
@@ -184,9 +456,8 @@ namespace Eigen {
     std::vector <To> ifft(const std::vector <From> &X)
     {
         using result_type = std::vector <To>;
-        result_type                                          retval;
-        Eigen::FFT <typename std::decomplexify <From>::type> fft;
-        fft.inv(retval, X);
+        result_type                                          retval(X.size());
+        fft_plan <typename std::decomplexify <From>::type, FFT_DIRECTION::INVERSE>(X.size()).execute(X.data(), retval.data());
 
         return retval;
     }
@@ -197,13 +468,35 @@ namespace Eigen {
     std::vector <Complex> ifft(const std::vector <Complex> &X)
     {
         using result_type = std::vector <Complex>;
-        result_type                                             retval;
-        Eigen::FFT <typename std::decomplexify <Complex>::type> fft;
-        fft.inv(retval, X);
+        result_type                                             retval(X.size());
+        fft_plan <typename std::decomplexify <Complex>::type, FFT_DIRECTION::INVERSE>(X.size()).execute(X.data(), retval.data());
 
         return retval;
     }
 
+    /*! @brief 出力先を指定する場合．xの大きさが合っていれば確保をしない
+    */
+    template <typename To, typename From>
+    void ifft(const std::vector <From> &X, std::vector <To> &x)
+    {
+        x.resize(X.size());
+        fft_plan <typename std::decomplexify <From>::type, FFT_DIRECTION::INVERSE>(X.size()).execute(X.data(), x.data());
+    }
+
+    /*! @brief 複素系列をその場で逆FFTする
+    */
+    template <typename Complex, typename std::enable_if <std::is_complex <Complex>::value>::type * = nullptr>
+    void ifft_inplace(std::vector <Complex> &X)
+    {
+        fft_plan <typename std::decomplexify <Complex>::type, FFT_DIRECTION::INVERSE>(X.size()).execute(X.data());
+    }
+
+    template <typename Complex, size_t N, typename std::enable_if <std::is_complex <Complex>::value>::type * = nullptr>
+    void ifft_inplace(std::array <Complex, N> &X)
+    {
+        fixed_fft <typename std::decomplexify <Complex>::type, FFT_DIRECTION::INVERSE, N>(X.data(), X.data());
+    }
+
     /*! @brief 多変量周波数系列の逆FFT．
         @tparam To 実数型または複素数型．
         指定しないと複素数型になる
@@ -212,62 +505,27 @@ namespace Eigen {
         @tparam Cols 列数
         @param X 周波数データ行列
         @param option 時間方向の縦横．デフォルト値はEigen::ColMajorでこのとき時間方向は縦
+        @param threads スレッド数．系列を分担する
     */
 
-    /*! @brief Eigen::Matrix用
-    */
-
-    /*! @brief 引数がstd::complex<double>>の場合を担保
+    /*! @brief Eigen::Matrix用．全系列をbatch_transformでまとめて変換する
     */
-    template <typename To, typename From, int Rows, int Cols, typename std::enable_if <std::is_same <From, typename std::complexify <From>::type>::value>::type * = nullptr>
-    Eigen::Matrix <To, Rows, Cols> ifft(const Eigen::Matrix <From, Rows, Cols> &X, const int option = Eigen::ColMajor)
+    template <typename To, typename From, int Rows, int Cols>
+    Eigen::Matrix <To, Rows, Cols> ifft(const Eigen::Matrix <From, Rows, Cols> &X, const int option = Eigen::ColMajor, const size_t threads = 1)
     {
         using result_type = Eigen::Matrix <To, Rows, Cols>;
-        const int                                            rows = X.rows();
-        const int                                            cols = X.cols();
-        result_type                                          retval(rows, cols);
-        Eigen::FFT <typename std::decomplexify <From>::type> fft;
-        if (option == Eigen::ColMajor) {
-            Eigen::Vector<To, Rows> tmp;
-            for (int j = 0; j < cols; j++) {
-                fft.inv(tmp, X.col(j).eval());
-                retval.col(j) = tmp;
-            }
-        } else {
-            Eigen::RowVector<To, Cols> tmp;
-            for (int i = 0; i < rows; i++) {
-                fft.inv(tmp, X.row(i).eval());
-                retval.row(i) = tmp;
-            }
-        }
+        result_type retval(X.rows(), X.cols());
+        batch_transform(fft_plan <typename std::decomplexify <From>::type, FFT_DIRECTION::INVERSE>, X, retval, option, threads);
 
         return retval;
     }
 
-    /*! @brief 引数がdoubleの場合を担保
-    */
-    template <typename To, typename From, int Rows, int Cols, typename std::enable_if <!std::is_same <From, typename std::complexify <From>::type>::value>::type * = nullptr>
-    Eigen::Matrix <To, Rows, Cols> ifft(const Eigen::Matrix <From, Rows, Cols> &X, const int option = Eigen::ColMajor)
-    {
-        const int                                            rows = X.rows();
-        const int                                            cols = X.cols();
-        using tmp_type = Eigen::Matrix <typename std::complexify <From>::type, Rows, Cols>;
-        tmp_type tmp(rows, cols);
-        for (int i = 0; i < rows; i++) {
-            for (int j = 0; j < cols; j++) {
-                tmp(i, j).real(X(i, j));
-                tmp(i, j).imag(0.);
-            }
-        }
-        return ifft<To>(tmp, option);
-    }
-
     /*! @brief 値域が指定されていない場合を担保
     */
     template <int Rows, int Cols, typename From>
-    Eigen::Matrix <typename std::complexify<From>::type, Rows, Cols> ifft(const Eigen::Matrix <From, Rows, Cols> &X, const int option = Eigen::ColMajor)
+    Eigen::Matrix <typename std::complexify<From>::type, Rows, Cols> ifft(const Eigen::Matrix <From, Rows, Cols> &X, const int option = Eigen::ColMajor, const size_t threads = 1)
     {
-        return ifft<typename std::complexify<From>::type>(X, option);
+        return ifft<typename std::complexify<From>::type>(X, option, threads);
     }
 }
 
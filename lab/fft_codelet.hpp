@@ -0,0 +1,346 @@
+/*! @file
+    @brief 長さをコンパイル時に固定したFFT（codelet）
+    @author templateaholic10
+*/
+#ifndef FFT_CODELET_HPP
+#define FFT_CODELET_HPP
+
+#include <complex>
+#include <utility>
+#include <type_traits>
+#include <constexpr/cmath>
+
+// 展開したループの本体がインライン化されないと関数呼び出しの方が重くなる
+#ifndef FFT_CODELET_INLINE
+#if defined(__GNUC__)
+#define FFT_CODELET_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define FFT_CODELET_INLINE __forceinline
+#else
+#define FFT_CODELET_INLINE inline
+#endif
+#endif
+
+namespace Eigen {
+    namespace codelet {
+        /*! @brief 全てのループを展開したcodeletを使うか
+            展開したcodeletは長さと型ごとに100KB程度のコードになりコンパイルも重いので，FFT_USE_CODELETを定義したときだけ使う．
+            2の冪でpow2_max_size以下の長さは，定義しなくても段だけを展開したRadix_codeletを使う
+        */
+#ifdef FFT_USE_CODELET
+        constexpr bool enabled = true;
+#else
+        constexpr bool enabled = false;
+#endif
+
+        /*! @brief 展開したcodeletを使う最大の長さ
+        */
+        constexpr size_t max_size = 64;
+
+        /*! @brief Radix_codeletを使う最大の長さ
+        */
+        constexpr size_t pow2_max_size = 32;
+
+        /*! @brief codeletを使う最大の素因数．これより大きい素因数があれば実行時のFFTを使う
+        */
+        constexpr size_t max_radix = 13;
+
+        /*! @brief 1段で分ける基数．4で割り切れれば4，そうでなければ最小の素因数
+        */
+        constexpr size_t radix(const size_t n)
+        {
+            if (n % 4 == 0) {
+                return 4;
+            }
+            for (size_t p = 2; p * p <= n; p++) {
+                if (n % p == 0) {
+                    return p;
+                }
+            }
+
+            return n;
+        }
+
+        /*! @brief nの最大の素因数
+        */
+        constexpr size_t largest_factor(const size_t n)
+        {
+            size_t m      = n;
+            size_t retval = 1;
+            for (size_t p = 2; p <= m; p++) {
+                while (m % p == 0) {
+                    m      /= p;
+                    retval  = p;
+                }
+            }
+
+            return retval;
+        }
+
+        constexpr bool is_pow2(const size_t n)
+        {
+            return n != 0 && (n & (n - 1)) == 0;
+        }
+
+        /*! @brief 長さNでRadix_codeletを使うか．長さ1は実行時のFFT（Eigen::FFT）が扱えないので常に使う
+        */
+        template <size_t N>
+        struct use_radix : std::integral_constant <bool, (is_pow2(N) && N <= pow2_max_size)> {
+        };
+
+        /*! @brief 長さNのcodeletがあるか
+        */
+        template <size_t N>
+        struct is_available : std::integral_constant <bool, (use_radix <N>::value || (enabled && N >= 1 && N <= max_size && largest_factor(N) <= max_radix))> {
+        };
+
+        /*! @brief 回転因子cos(2 pi k / N)，sin(2 pi k / N)の表．4分の1周期の倍数は厳密な値にする
+            @tparam Scalar 実数型．long doubleで計算してからScalarに丸める
+        */
+        template <typename Scalar, size_t N>
+        struct Twiddle_table {
+            Scalar c[N];
+            Scalar s[N];
+        };
+
+        template <typename Scalar, size_t N>
+        constexpr Twiddle_table <Scalar, N> make_twiddles()
+        {
+            Twiddle_table <Scalar, N> retval{};
+            for (size_t k = 0; k < N; k++) {
+                if ((4 * k) % N == 0) {
+                    const size_t quarter = 4 * k / N;
+                    retval.c[k] = (quarter == 0) ? 1 : (quarter == 2) ? -1 : 0;
+                    retval.s[k] = (quarter == 1) ? 1 : (quarter == 3) ? -1 : 0;
+                } else {
+                    retval.c[k] = static_cast <Scalar>(cpstd::cos(2 * cpstd::pi_v <long double> * k / N));
+                    retval.s[k] = static_cast <Scalar>(cpstd::sin(2 * cpstd::pi_v <long double> * k / N));
+                }
+            }
+
+            return retval;
+        }
+
+        template <typename Scalar, size_t N>
+        struct Twiddles {
+            static constexpr Twiddle_table <Scalar, N> table = make_twiddles <Scalar, N>();
+        };
+
+        template <typename Scalar, size_t N>
+        constexpr Twiddle_table <Scalar, N> Twiddles <Scalar, N>::table;
+
+        using expand = int[];
+
+        /*! @brief x * exp(Sign 2 pi i K / N)．Signは順変換で-1，逆変換で+1
+            std::complexの積はNaNの扱いのため遅いので展開して書く．
+            4分の1周期の倍数では積を使わない
+        */
+        template <typename Scalar, int Sign, size_t N, size_t K>
+        FFT_CODELET_INLINE std::complex <Scalar> rotate(const std::complex <Scalar> &x)
+        {
+            constexpr size_t k = K % N;
+            if ((4 * k) % N == 0) {
+                switch (4 * k / N) {
+                    case 0:
+                        return x;
+                    case 1:
+                        return std::complex <Scalar>(-Sign * x.imag(), Sign * x.real());
+                    case 2:
+                        return -x;
+                    default:
+                        return std::complex <Scalar>(Sign * x.imag(), -Sign * x.real());
+                }
+            }
+            constexpr Scalar c = Twiddles <Scalar, N>::table.c[k];
+            constexpr Scalar s = Sign * Twiddles <Scalar, N>::table.s[k];
+
+            return std::complex <Scalar>(c * x.real() - s * x.imag(), c * x.imag() + s * x.real());
+        }
+
+        /*! @brief 実数入力の場合
+        */
+        template <typename Scalar, int Sign, size_t N, size_t K>
+        FFT_CODELET_INLINE std::complex <Scalar> rotate(const Scalar x)
+        {
+            constexpr size_t k = K % N;
+            if ((4 * k) % N == 0) {
+                switch (4 * k / N) {
+                    case 0:
+                        return std::complex <Scalar>(x, 0.);
+                    case 1:
+                        return std::complex <Scalar>(0., Sign * x);
+                    case 2:
+                        return std::complex <Scalar>(-x, 0.);
+                    default:
+                        return std::complex <Scalar>(0., -Sign * x);
+                }
+            }
+            constexpr Scalar c = Twiddles <Scalar, N>::table.c[k];
+            constexpr Scalar s = Sign * Twiddles <Scalar, N>::table.s[k];
+
+            return std::complex <Scalar>(c * x, s * x);
+        }
+
+        /*! @brief 長さPの素朴なDFTの第R成分．sum_q in[q * in_stride] exp(Sign 2 pi i q R / P)
+        */
+        template <typename Scalar, int Sign, size_t P, size_t R, typename From, size_t ... Q>
+        FFT_CODELET_INLINE std::complex <Scalar> dft_bin(const From *in, const size_t in_stride, std::index_sequence <Q ...>)
+        {
+            std::complex <Scalar> acc(0., 0.);
+            (void)expand { 0, (acc += rotate <Scalar, Sign, P, Q * R>(in[Q * in_stride]), 0) ... };
+
+            return acc;
+        }
+
+        /*! @brief 長さPの素朴なDFT．out[r * out_stride]に第r成分を書く
+        */
+        template <typename Scalar, int Sign, size_t P, typename From, size_t ... R>
+        FFT_CODELET_INLINE void dft(const From *in, const size_t in_stride, std::complex <Scalar> *out, const size_t out_stride, std::index_sequence <R ...>)
+        {
+            (void)expand { 0, (out[R * out_stride] = dft_bin <Scalar, Sign, P, R>(in, in_stride, std::make_index_sequence <P>()), 0) ... };
+        }
+
+        /*! @class
+            @brief 長さNのFFT．基数Pの時間間引きで長さN / Pの変換に分け，ループを全て展開する
+            @tparam Scalar 実数型
+            @tparam Sign 順変換で-1，逆変換で+1
+            スケーリングはしない．outはinと重なってはいけない
+        */
+        template <typename Scalar, int Sign, size_t N, size_t P = radix(N)>
+        struct Codelet {
+            using complex_type = std::complex <Scalar>;
+            static constexpr size_t M = N / P;
+
+            /*! @param in 入力．in[t * stride]が第t標本
+                @param out 出力．連続したN個
+            */
+            template <typename From>
+            static FFT_CODELET_INLINE void run(const From *in, const size_t stride, complex_type *out)
+            {
+                split(in, stride, out, std::make_index_sequence <P>());
+                butterflies(out, std::make_index_sequence <M>());
+            }
+
+        private:
+            // 間引いたP本の系列をそれぞれ変換してout[q * M, (q + 1) * M)に書く
+            template <typename From, size_t ... Q>
+            static FFT_CODELET_INLINE void split(const From *in, const size_t stride, complex_type *out, std::index_sequence <Q ...>)
+            {
+                (void)expand { 0, (Codelet <Scalar, Sign, M>::run(in + Q * stride, stride * P, out + Q * M), 0) ... };
+            }
+
+            // 第K成分の組に回転因子を掛けて長さPのDFTをする
+            template <size_t K, size_t ... Q>
+            static FFT_CODELET_INLINE void butterfly(complex_type *out, std::index_sequence <Q ...>)
+            {
+                const complex_type t[P] = { rotate <Scalar, Sign, N, Q * K>(out[Q * M + K]) ... };
+                dft <Scalar, Sign, P>(t, 1, out + K, M, std::make_index_sequence <P>());
+            }
+
+            template <size_t ... K>
+            static FFT_CODELET_INLINE void butterflies(complex_type *out, std::index_sequence <K ...>)
+            {
+                (void)expand { 0, (butterfly <K>(out, std::make_index_sequence <P>()), 0) ... };
+            }
+        };
+
+        /*! @brief 素数長は素朴なDFT
+        */
+        template <typename Scalar, int Sign, size_t N>
+        struct Codelet <Scalar, Sign, N, N> {
+            template <typename From>
+            static FFT_CODELET_INLINE void run(const From *in, const size_t stride, std::complex <Scalar> *out)
+            {
+                dft <Scalar, Sign, N>(in, stride, out, 1, std::make_index_sequence <N>());
+            }
+        };
+
+        template <typename Scalar, int Sign>
+        struct Codelet <Scalar, Sign, 1, 1> {
+            template <typename From>
+            static FFT_CODELET_INLINE void run(const From *in, const size_t, std::complex <Scalar> *out)
+            {
+                out[0] = in[0];
+            }
+        };
+
+        /*! @class
+            @brief 2の冪の長さNのFFT．基数4（Nが4で割り切れなければ2）の時間間引きで，段の再帰だけを展開する
+            @tparam Scalar 実数型
+            @tparam Sign 順変換で-1，逆変換で+1
+            各段のバタフライは通常のループで回し，回転因子は表を引くので，長さごとのコードは小さい．
+            スケーリングはしない．outはinと重なってはいけない
+        */
+        template <typename Scalar, int Sign, size_t N>
+        struct Radix_codelet {
+            using complex_type = std::complex <Scalar>;
+            static constexpr size_t P = (N % 4 == 0) ? 4 : 2;
+            static constexpr size_t M = N / P;
+
+            /*! @param in 入力．in[t * stride]が第t標本
+                @param out 出力．連続したN個
+            */
+            template <typename From>
+            static FFT_CODELET_INLINE void run(const From *in, const size_t stride, complex_type *out)
+            {
+                for (size_t q = 0; q < P; q++) {
+                    Radix_codelet <Scalar, Sign, M>::run(in + q * stride, stride * P, out + q * M);
+                }
+                for (size_t k = 0; k < M; k++) {
+                    butterfly(out, k, std::integral_constant <size_t, P>());
+                }
+            }
+
+        private:
+            // x * exp(Sign 2 pi i j / N)
+            static FFT_CODELET_INLINE complex_type rotate(const complex_type &x, const size_t j)
+            {
+                const Scalar c = Twiddles <Scalar, N>::table.c[j];
+                const Scalar s = Sign * Twiddles <Scalar, N>::table.s[j];
+
+                return complex_type(c * x.real() - s * x.imag(), c * x.imag() + s * x.real());
+            }
+
+            static FFT_CODELET_INLINE void butterfly(complex_type *out, const size_t k, std::integral_constant <size_t, 2>)
+            {
+                const complex_type a0 = out[k];
+                const complex_type a1 = rotate(out[M + k], k);
+                out[k]     = a0 + a1;
+                out[M + k] = a0 - a1;
+            }
+
+            static FFT_CODELET_INLINE void butterfly(complex_type *out, const size_t k, std::integral_constant <size_t, 4>)
+            {
+                const complex_type a0 = out[k];
+                const complex_type a1 = rotate(out[M + k], k);
+                const complex_type a2 = rotate(out[2 * M + k], 2 * k);
+                const complex_type a3 = rotate(out[3 * M + k], 3 * k);
+                const complex_type b0 = a0 + a2;
+                const complex_type b1 = a0 - a2;
+                const complex_type b2 = a1 + a3;
+                // (a1 - a3) * exp(Sign pi i / 2)
+                const complex_type b3(-Sign * (a1.imag() - a3.imag()), Sign * (a1.real() - a3.real()));
+                out[k]         = b0 + b2;
+                out[M + k]     = b1 + b3;
+                out[2 * M + k] = b0 - b2;
+                out[3 * M + k] = b1 - b3;
+            }
+        };
+
+        template <typename Scalar, int Sign>
+        struct Radix_codelet <Scalar, Sign, 1> {
+            template <typename From>
+            static FFT_CODELET_INLINE void run(const From *in, const size_t, std::complex <Scalar> *out)
+            {
+                out[0] = in[0];
+            }
+        };
+
+        /*! @brief 長さNで使うcodelet
+        */
+        template <typename Scalar, int Sign, size_t N>
+        using Selected = typename std::conditional <use_radix <N>::value, Radix_codelet <Scalar, Sign, N>, Codelet <Scalar, Sign, N> >::type;
+    }
+}
+
+#endif
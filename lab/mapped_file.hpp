@@ -0,0 +1,115 @@
+/*! @file
+    @brief 読み込み専用のメモリマップトファイル(POSIX mmap)
+    @author templateaholic10
+*/
+
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*! @class
+    @brief ファイル全体を読み込み専用でmmapする．ページは他プロセスと共有される．
+    ムーブのみ可能
+*/
+class Mapped_file {
+private:
+    const unsigned char *_data;
+    std::size_t          _size;
+public:
+    Mapped_file()
+        : _data(nullptr), _size(0)
+    {
+    }
+
+    explicit Mapped_file(const std::string &filename)
+        : _data(nullptr), _size(0)
+    {
+        open(filename);
+    }
+
+    Mapped_file(const Mapped_file&)           = delete;
+    Mapped_file&operator=(const Mapped_file&) = delete;
+
+    Mapped_file(Mapped_file &&other)
+        : _data(other._data), _size(other._size)
+    {
+        other._data = nullptr;
+        other._size = 0;
+    }
+
+    Mapped_file&operator=(Mapped_file &&other)
+    {
+        if (this != &other) {
+            close();
+            std::swap(_data, other._data);
+            std::swap(_size, other._size);
+        }
+
+        return *this;
+    }
+
+    ~Mapped_file()
+    {
+        close();
+    }
+
+    /*! @brief ファイルをマップする
+        @return 成功したか
+    */
+    bool open(const std::string &filename)
+    {
+        close();
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void *p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        // マップはfdを閉じても残る
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        _data = static_cast <const unsigned char *>(p);
+        _size = st.st_size;
+
+        return true;
+    }
+
+    void close()
+    {
+        if (_data != nullptr) {
+            ::munmap(const_cast <unsigned char *>(_data), _size);
+            _data = nullptr;
+            _size = 0;
+        }
+    }
+
+    bool is_open() const
+    {
+        return _data != nullptr;
+    }
+
+    const unsigned char *data() const
+    {
+        return _data;
+    }
+
+    std::size_t size() const
+    {
+        return _size;
+    }
+};
+
+#endif
@@ -0,0 +1,353 @@
+/*! @file
+    @brief 逐次STFT，スライディング窓DCT
+    @author templateaholic10
+*/
+#ifndef STFT_HPP
+#define STFT_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <fft>
+#include <dct>
+
+namespace Eigen {
+    /*! @brief 窓関数の種類
+    */
+    enum class WINDOW { RECTANGULAR, HANN, HAMMING };
+
+    /*! @brief 長さnの周期的な窓関数．w_t = a0 - a1 cos(2 pi t / n)
+    */
+    template <typename Scalar>
+    std::vector <Scalar> make_window(const WINDOW kind, const size_t n)
+    {
+        std::vector <Scalar> retval(n, Scalar(1.));
+        const Scalar         a0 = (kind == WINDOW::HAMMING) ? Scalar(0.54) : Scalar(0.5);
+        if (kind != WINDOW::RECTANGULAR) {
+            for (size_t t = 0; t < n; t++) {
+                retval[t] = a0 - (Scalar(1.) - a0) * std::cos(Scalar(2. * M_PI) * t / n);
+            }
+        }
+
+        return retval;
+    }
+
+    /*! @class
+        @brief 呼び出し側が持つ領域の上のフレームのリングバッファ
+        @tparam T 要素型
+        満杯のときpushすると最も古いフレームを上書きする
+    */
+    template <typename T>
+    class Frame_ring {
+    private:
+        T *const     _data;
+        const size_t _frame_size;
+        const size_t _capacity;
+        size_t       _head; // 最も古いフレームの位置
+        size_t       _size;
+    public:
+        /*! @param data frame_size * capacity個の要素を持つ領域
+            @param frame_size 1フレームの要素数
+            @param capacity フレーム数
+        */
+        Frame_ring(T *data, const size_t frame_size, const size_t capacity)
+            : _data(data), _frame_size(frame_size), _capacity(capacity), _head(0), _size(0)
+        {
+        }
+
+        size_t frame_size() const
+        {
+            return _frame_size;
+        }
+
+        size_t capacity() const
+        {
+            return _capacity;
+        }
+
+        size_t size() const
+        {
+            return _size;
+        }
+
+        bool empty() const
+        {
+            return _size == 0;
+        }
+
+        /*! @brief 次のフレームを書く場所を確保して返す
+        */
+        T *push()
+        {
+            if (_size == _capacity) {
+                _head = (_head + 1) % _capacity;
+                _size--;
+            }
+            T *retval = _data + ((_head + _size) % _capacity) * _frame_size;
+            _size++;
+
+            return retval;
+        }
+
+        /*! @brief 古い方からi番目のフレーム
+        */
+        const T *operator[](const size_t i) const
+        {
+            return _data + ((_head + i) % _capacity) * _frame_size;
+        }
+
+        const T *front() const
+        {
+            return (*this)[0];
+        }
+
+        /*! @brief 最も古いフレームを捨てる
+        */
+        void pop()
+        {
+            if (_size > 0) {
+                _head = (_head + 1) % _capacity;
+                _size--;
+            }
+        }
+    };
+
+    /*! @class
+        @brief 標本を1つずつ受け取り，直近n標本のフレームをhop標本ごとに作る
+        最初のフレームはn標本目で作る．hop > nのときフレームの間の標本は使わない
+    */
+    template <typename Scalar>
+    class Framer {
+    protected:
+        const size_t         _n;
+        const size_t         _hop;
+        std::vector <Scalar> _window;
+        std::vector <Scalar> _history;   // 直近n標本の循環バッファ
+        std::vector <Scalar> _frame;     // 古い順に並べたフレーム
+        size_t               _pos;       // 次に書く位置．最も古い標本の位置でもある
+        size_t               _countdown; // 次のフレームまでの標本数
+    public:
+        Framer(const size_t n, const size_t hop, const std::vector <Scalar> &window)
+            : _n(n), _hop(hop), _window(window), _history(n), _frame(n)
+        {
+            reset();
+        }
+
+        size_t size() const
+        {
+            return _n;
+        }
+
+        size_t hop() const
+        {
+            return _hop;
+        }
+
+        /*! @brief 受け取った標本を捨てて最初の状態に戻す
+        */
+        void reset()
+        {
+            std::fill(_history.begin(), _history.end(), Scalar(0.));
+            _pos       = 0;
+            _countdown = _n;
+        }
+
+    protected:
+        /*! @brief 標本を1つ受け取る
+            @param old 押し出された標本
+            @return フレームができたか
+        */
+        bool feed(const Scalar x, Scalar &old)
+        {
+            old            = _history[_pos];
+            _history[_pos] = x;
+            _pos           = (_pos + 1 == _n) ? 0 : _pos + 1;
+            if (--_countdown == 0) {
+                _countdown = _hop;
+
+                return true;
+            }
+
+            return false;
+        }
+
+        /*! @brief 古い順に並べたフレームを_frameに作る
+        */
+        void unroll(const bool windowed)
+        {
+            std::copy(_history.begin() + _pos, _history.end(), _frame.begin());
+            std::copy(_history.begin(), _history.begin() + _pos, _frame.begin() + (_n - _pos));
+            if (windowed) {
+                for (size_t t = 0; t < _n; t++) {
+                    _frame[t] *= _window[t];
+                }
+            }
+        }
+    };
+
+    /*! @class
+        @brief 逐次STFT．標本を受け取るたびにhop標本ごとのスペクトル（長さn）をリングバッファに書く
+        @tparam Scalar 実数型
+        hop = 1で窓が矩形，Hann，Hammingのときは，スライディングDFTで1標本あたりO(n)で更新する．
+        窓a0 - a1 cos(2 pi t / n)は周波数領域で a0 X_k - a1 / 2 (X_{k-1} + X_{k+1}) と3項で掛かる．
+        丸め誤差が溜まらないよう，resyncフレームごとにFFTで計算し直す
+    */
+    template <typename Scalar>
+    class STFT : public Framer <Scalar> {
+    public:
+        using complex_type = std::complex <Scalar>;
+
+        /*! @brief スライディングDFTでFFTから計算し直す間隔（フレーム数）．0のとき計算し直さない
+        */
+        static size_t resync;
+    private:
+        using Framer <Scalar>::_n;
+        using Framer <Scalar>::_frame;
+
+        FFT_plan <Scalar, FFT_DIRECTION::FORWARD> _plan;
+        const bool                                _sliding;
+        Scalar                                    _a0;
+        Scalar                                    _a1;
+        std::vector <complex_type>                _X;       // 窓を掛けない現在のスペクトル
+        std::vector <complex_type>                _twiddle; // exp(2 pi i k / n)
+        bool                                      _synced;
+        size_t                                    _since_sync;
+    public:
+        /*! @param n 窓の長さ
+            @param hop フレームの間隔．重なりはn - hop
+            @param kind 窓関数
+        */
+        STFT(const size_t n, const size_t hop, const WINDOW kind = WINDOW::HANN)
+            : Framer <Scalar>(n, hop, make_window <Scalar>(kind, n)), _plan(n), _sliding(hop == 1),
+            _a0((kind == WINDOW::RECTANGULAR) ? Scalar(1.) : (kind == WINDOW::HAMMING) ? Scalar(0.54) : Scalar(0.5)), _a1(Scalar(1.) - _a0),
+            _X(n), _twiddle(n), _synced(false), _since_sync(0)
+        {
+            for (size_t k = 0; k < n; k++) {
+                _twiddle[k] = std::polar(Scalar(1.), Scalar(2. * M_PI) * k / n);
+            }
+        }
+
+        /*! @param window 長さnの任意の窓．スライディングDFTは使わない
+        */
+        STFT(const size_t n, const size_t hop, const std::vector <Scalar> &window)
+            : Framer <Scalar>(n, hop, window), _plan(n), _sliding(false), _a0(1.), _a1(0.), _synced(false), _since_sync(0)
+        {
+        }
+
+        /*! @brief count個の標本を受け取り，できたフレームのスペクトルをoutに書く
+            @param out フレームの要素数がn以上のリングバッファ
+            @return 書いたフレーム数
+        */
+        size_t push(const Scalar *x, const size_t count, Frame_ring <complex_type> &out)
+        {
+            size_t frames = 0;
+            Scalar old;
+            for (size_t i = 0; i < count; i++) {
+                const bool ready = this->feed(x[i], old);
+                if (_sliding && _synced) {
+                    const Scalar diff = x[i] - old;
+                    for (size_t k = 0; k < _n; k++) {
+                        _X[k] = _twiddle[k] * (_X[k] + diff);
+                    }
+                }
+                if (ready) {
+                    emit(out.push());
+                    frames++;
+                }
+            }
+
+            return frames;
+        }
+
+        size_t push(const Scalar x, Frame_ring <complex_type> &out)
+        {
+            return push(&x, 1, out);
+        }
+
+        void reset()
+        {
+            Framer <Scalar>::reset();
+            _synced = false;
+        }
+
+    private:
+        void emit(complex_type *spectrum)
+        {
+            if (!_sliding) {
+                this->unroll(true);
+                _plan.execute(_frame.data(), spectrum);
+
+                return;
+            }
+            if (!_synced || (resync > 0 && ++_since_sync >= resync)) {
+                this->unroll(false);
+                _plan.execute(_frame.data(), _X.data());
+                _synced     = true;
+                _since_sync = 0;
+            }
+            if (_a1 == Scalar(0.)) {
+                std::copy(_X.begin(), _X.end(), spectrum);
+
+                return;
+            }
+            const Scalar half = Scalar(0.5) * _a1;
+            for (size_t k = 0; k < _n; k++) {
+                const complex_type &prev = _X[(k == 0) ? _n - 1 : k - 1];
+                const complex_type &next = _X[(k + 1 == _n) ? 0 : k + 1];
+                spectrum[k] = _a0 * _X[k] - half * (prev + next);
+            }
+        }
+    };
+
+    template <typename Scalar>
+    size_t STFT <Scalar>::resync = 1024;
+
+    /*! @class
+        @brief スライディング窓DCT．hop標本ごとに窓を掛けたフレームのDCT（長さn）をリングバッファに書く
+        @tparam Scalar 実数型
+        @tparam Type DCTの型．デフォルトはDCT-2
+    */
+    template <typename Scalar, DCT_TYPE Type = DCT_TYPE::II>
+    class Sliding_DCT : public Framer <Scalar> {
+    private:
+        using Framer <Scalar>::_frame;
+
+        DCT_plan <Scalar, Type, FFT_DIRECTION::FORWARD> _plan;
+    public:
+        Sliding_DCT(const size_t n, const size_t hop, const WINDOW kind = WINDOW::RECTANGULAR)
+            : Framer <Scalar>(n, hop, make_window <Scalar>(kind, n)), _plan(n)
+        {
+        }
+
+        Sliding_DCT(const size_t n, const size_t hop, const std::vector <Scalar> &window)
+            : Framer <Scalar>(n, hop, window), _plan(n)
+        {
+        }
+
+        /*! @brief count個の標本を受け取り，できたフレームの係数をoutに書く
+            @return 書いたフレーム数
+        */
+        size_t push(const Scalar *x, const size_t count, Frame_ring <Scalar> &out)
+        {
+            size_t frames = 0;
+            Scalar old;
+            for (size_t i = 0; i < count; i++) {
+                if (this->feed(x[i], old)) {
+                    this->unroll(true);
+                    _plan.execute(_frame.data(), out.push());
+                    frames++;
+                }
+            }
+
+            return frames;
+        }
+
+        size_t push(const Scalar x, Frame_ring <Scalar> &out)
+        {
+            return push(&x, 1, out);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef SUCCINCT_BIN
+#define SUCCINCT_BIN
+
+#include <cstdint>
+#include <cstring>
+#include "bin_container.hpp"
+
+namespace succinct {
+    // ビット列，ウェーブレット行列のバイナリ形式．
+    // 入れ物はbin_containerと同じで，[ヘッダ64バイト][区画]...の各区画を64バイト境界まで詰める．
+    // ファイルをmmapすれば，区画をそのままキャッシュラインに揃った配列として使える．
+    // BIT_VECTOR:     ライン | selectの標本(1) | selectの標本(0)
+    // WAVELET_MATRIX: 各レベルの0の数 | レベルごとのBIT_VECTOR
+    namespace bin {
+        enum Kind : std::uint32_t
+        {
+            BIT_VECTOR     = 1,
+            WAVELET_MATRIX = 2,
+        };
+
+        constexpr std::uint32_t version = 1;
+
+        // 入れ物の読み書きはEigenのバイナリ形式と共有する
+        using bin_container::byte_order;
+        using bin_container::alignment;
+        using bin_container::padded;
+        using bin_container::write_header;
+        using bin_container::read_header;
+        using bin_container::remaining;
+        using bin_container::write_section;
+        using bin_container::read_section;
+
+        struct Header {
+            char          magic[4];
+            std::uint32_t version;
+            std::uint32_t byte_order;
+            std::uint32_t kind;
+            // 要素数
+            std::uint64_t length;
+            // BIT_VECTORは1の数，WAVELET_MATRIXはレベル数
+            std::uint64_t count;
+            // 書き手と読み手で一致しなければならない構造の値（ラインの語数や標本間隔など）
+            std::uint64_t layout;
+            std::uint64_t reserved[3];
+        };
+        static_assert(sizeof(Header) == alignment, "Header must fill one alignment unit");
+
+        inline Header make_header(const Kind kind, const std::uint64_t length, const std::uint64_t count, const std::uint64_t layout)
+        {
+            Header header;
+            std::memset(&header, 0, sizeof(header));
+            std::memcpy(header.magic, "SBIN", 4);
+            header.version    = version;
+            header.byte_order = byte_order;
+            header.kind       = kind;
+            header.length     = length;
+            header.count      = count;
+            header.layout     = layout;
+
+            return header;
+        }
+
+        // ヘッダが期待する種類と構造か
+        inline bool check_header(const Header &header, const Kind kind, const std::uint64_t layout)
+        {
+            return std::memcmp(header.magic, "SBIN", 4) == 0 && header.version == version && header.byte_order == byte_order &&
+                   header.kind == kind && header.layout == layout;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,223 @@
+/*! @file
+    @brief スレッドプールと区間並列ループ
+    @author templateaholic10
+*/
+
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace parallel {
+    /*! @brief ハードウェアスレッド数．取得できない場合は1
+    */
+    inline std::size_t hardware_threads()
+    {
+        const std::size_t n = std::thread::hardware_concurrency();
+
+        return n == 0 ? 1 : n;
+    }
+
+    /*! @class
+        @brief 固定数のワーカーを持つスレッドプール．
+        parallel_forでは呼び出し元スレッドも区間を処理するので，プールのタスク内から入れ子で呼んでもデッドロックしない
+    */
+    class Thread_pool {
+    private:
+        std::vector <std::thread>            _workers;
+        std::deque <std::function <void()> > _tasks;
+        std::mutex                           _mutex;
+        std::condition_variable              _cv;
+        bool                                 _stop;
+    public:
+        /*! @param threads ワーカー数．0のときワーカーを持たず，すべて呼び出し元で実行する
+        */
+        explicit Thread_pool(const std::size_t threads=hardware_threads())
+            : _stop(false)
+        {
+            _workers.reserve(threads);
+            for (std::size_t i = 0; i < threads; i++) {
+                _workers.emplace_back([this]() {
+                    work();
+                });
+            }
+        }
+
+        Thread_pool(const Thread_pool&)           = delete;
+        Thread_pool&operator=(const Thread_pool&) = delete;
+
+        ~Thread_pool()
+        {
+            {
+                std::lock_guard <std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _cv.notify_all();
+            for (auto &worker : _workers) {
+                worker.join();
+            }
+        }
+
+        std::size_t size() const
+        {
+            return _workers.size();
+        }
+
+        /*! @brief タスクを投入する
+            @return 結果のfuture
+        */
+        template <class F, class Result = decltype(std::declval <typename std::decay <F>::type &>()())>
+        std::future <Result> submit(F &&f)
+        {
+            using result_type = Result;
+            auto task = std::make_shared <std::packaged_task <result_type()> >(std::forward <F>(f));
+            std::future <result_type> retval = task->get_future();
+            if (_workers.empty()) {
+                (*task)();
+
+                return retval;
+            }
+            {
+                std::lock_guard <std::mutex> lock(_mutex);
+                _tasks.emplace_back([task]() {
+                    (*task)();
+                });
+            }
+            _cv.notify_one();
+
+            return retval;
+        }
+
+        /*! @brief [first, last)をおよそgrain幅の区間に分け，f(begin, end)を並列に呼ぶ．
+            区間の分け方はスレッド数とgrainだけで決まるので，区間ごとの部分和を順に足せば結果は再現する．
+            fが投げた例外は全区間の終了を待ってから呼び出し元で投げ直す（最初の1つだけ）．以降の区間は呼ばない
+            @param grain 区間幅の下限
+        */
+        template <class F>
+        void parallel_for(const std::ptrdiff_t first, const std::ptrdiff_t last, F f, const std::ptrdiff_t grain=1)
+        {
+            const std::ptrdiff_t length = last - first;
+            if (length <= 0) {
+                return;
+            }
+            const std::ptrdiff_t chunks = chunk_num(length, grain);
+            if (chunks == 1) {
+                f(first, last);
+
+                return;
+            }
+
+            // 遅れて起動した補助タスクからも参照されるので共有する
+            struct State {
+                std::atomic <std::ptrdiff_t> next;
+                std::atomic <std::ptrdiff_t> done;
+                std::atomic <bool>           failed;
+                std::exception_ptr           error;
+                std::mutex                   mutex;
+                std::condition_variable      cv;
+            };
+            auto state = std::make_shared <State>();
+            state->next   = 0;
+            state->done   = 0;
+            state->failed = false;
+            // 例外が出ても区間の取得と完了の数え上げは続け，doneが必ずchunksに届くようにする
+            auto run = [state, first, length, chunks, f]() {
+                for (;; ) {
+                    const std::ptrdiff_t c = state->next++;
+                    if (c >= chunks) {
+                        return;
+                    }
+                    if (!state->failed) {
+                        try {
+                            f(first + length*c/chunks, first + length*(c + 1)/chunks);
+                        } catch (...) {
+                            std::lock_guard <std::mutex> lock(state->mutex);
+                            if (!state->error) {
+                                state->error = std::current_exception();
+                            }
+                            state->failed = true;
+                        }
+                    }
+                    if (++state->done == chunks) {
+                        std::lock_guard <std::mutex> lock(state->mutex);
+                        state->cv.notify_all();
+                    }
+                }
+            };
+            const std::size_t helpers = std::min <std::size_t>(_workers.size(), chunks - 1);
+            {
+                std::lock_guard <std::mutex> lock(_mutex);
+                for (std::size_t i = 0; i < helpers; i++) {
+                    _tasks.emplace_back(run);
+                }
+            }
+            _cv.notify_all();
+            run();
+            std::unique_lock <std::mutex> lock(state->mutex);
+            state->cv.wait(lock, [&state, chunks]() {
+                return state->done == chunks;
+            });
+            if (state->error) {
+                std::rethrow_exception(state->error);
+            }
+        }
+
+        /*! @brief parallel_forの区間数
+        */
+        std::ptrdiff_t chunk_num(const std::ptrdiff_t length, const std::ptrdiff_t grain=1) const
+        {
+            const std::ptrdiff_t by_grain = std::max <std::ptrdiff_t>(length/std::max <std::ptrdiff_t>(grain, 1), 1);
+
+            return std::min <std::ptrdiff_t>(static_cast <std::ptrdiff_t>(_workers.size()) + 1, by_grain);
+        }
+
+    private:
+        void work()
+        {
+            for (;; ) {
+                std::function <void()> task;
+                {
+                    std::unique_lock <std::mutex> lock(_mutex);
+                    _cv.wait(lock, [this]() {
+                        return _stop || !_tasks.empty();
+                    });
+                    if (_stop && _tasks.empty()) {
+                        return;
+                    }
+                    task = std::move(_tasks.front());
+                    _tasks.pop_front();
+                }
+                task();
+            }
+        }
+    };
+
+    /*! @brief プールがあれば並列に，なければ逐次にf(begin, end)を呼ぶ
+    */
+    template <class F>
+    void for_range(Thread_pool *pool, const std::ptrdiff_t first, const std::ptrdiff_t last, F f, const std::ptrdiff_t grain=1)
+    {
+        if (pool == nullptr) {
+            if (first < last) {
+                f(first, last);
+            }
+        } else {
+            pool->parallel_for(first, last, f, grain);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,411 @@
+/*! @file
+    @brief FFTによる畳み込み，相互相関
+    @author templateaholic10
+*/
+#ifndef UTIL_CONV
+#define UTIL_CONV
+
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <complex>
+#include <vector>
+#include <fft>
+
+namespace util {
+    namespace detail {
+        /*! @brief 積．std::complexの積はNaNの扱いのため遅いので展開して書く
+        */
+        template <typename Scalar>
+        inline Scalar mul(const Scalar a, const Scalar b)
+        {
+            return a * b;
+        }
+
+        template <typename Scalar>
+        inline std::complex <Scalar> mul(const std::complex <Scalar> &a, const std::complex <Scalar> &b)
+        {
+            return std::complex <Scalar>(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+        }
+
+        /*! @brief 複素共役．実数はそのまま返す
+        */
+        template <typename Scalar>
+        inline Scalar conjugate(const Scalar a)
+        {
+            return a;
+        }
+
+        template <typename Scalar>
+        inline std::complex <Scalar> conjugate(const std::complex <Scalar> &a)
+        {
+            return std::conj(a);
+        }
+    }
+
+    /*! @brief n以上で4の倍数かつ素因数が2, 3, 5だけの最小の長さ．実数のFFTが速い
+    */
+    inline size_t fft_good_size(const size_t n)
+    {
+        size_t m = std::max <size_t>((n + 3) / 4 * 4, 4);
+        for (; ; m += 4) {
+            size_t r = m;
+            for (const size_t p : { 2, 3, 5 }) {
+                while (r % p == 0) {
+                    r /= p;
+                }
+            }
+            if (r == 1) {
+                return m;
+            }
+        }
+    }
+
+    /*! @class
+        @brief カーネルhを固定した線形畳み込み．長いカーネルは長さLのFFTによる重畳加算法で計算する
+        @tparam T 実数型または複素数型
+        カーネルのスペクトルを持っておき，同じカーネルで多数の系列を畳み込むときに使い回す．
+        カーネル長がdirect_limit（またはコンストラクタに渡した値）以下なら直接計算する．
+        FFTの計画はスレッドごとのキャッシュから取るので，作ったスレッドで使う
+    */
+    template <typename T>
+    class Convolver {
+    public:
+        using scalar_type  = typename std::decomplexify <T>::type;
+        using complex_type = std::complex <scalar_type>;
+
+        /*! @brief カーネル長がこれ以下なら直接計算する．calibrate_convolutionで測り直せる
+            他のスレッドがConvolverを作っている間に書き換えてもよい
+        */
+        static std::atomic <size_t> direct_limit;
+    private:
+        using Forward = Eigen::FFT_plan <scalar_type, Eigen::FFT_DIRECTION::FORWARD>;
+        using Inverse = Eigen::FFT_plan <scalar_type, Eigen::FFT_DIRECTION::INVERSE>;
+
+        const size_t               _m;
+        const bool                 _direct;
+        const size_t               _L;
+        std::vector <T>            _h;
+        Forward                   *_fwd;
+        Inverse                   *_inv;
+        std::vector <complex_type> _H;    // カーネルのスペクトル
+        std::vector <complex_type> _spec;
+        std::vector <T>            _buf;
+    public:
+        /*! @param h カーネル
+            @param m カーネル長（1以上）
+            @param fft_size FFTの長さの下限．0のとき4m．実際の長さはfft_good_sizeで切り上げる
+            @param limit カーネル長がこれ以下なら直接計算する．省略時はdirect_limit
+        */
+        Convolver(const T *h, const size_t m, const size_t fft_size = 0, const size_t limit = direct_limit.load())
+            : _m(m), _direct(m <= limit), _L(_direct ? 0 : fft_good_size(std::max(fft_size == 0 ? 4 * m : fft_size, m))),
+            _h(h, h + m), _fwd(nullptr), _inv(nullptr)
+        {
+            if (_direct) {
+                return;
+            }
+            _fwd = &Eigen::fft_plan <scalar_type, Eigen::FFT_DIRECTION::FORWARD>(_L);
+            _inv = &Eigen::fft_plan <scalar_type, Eigen::FFT_DIRECTION::INVERSE>(_L);
+            _H.resize(_L);
+            _spec.resize(_L);
+            _buf.assign(_L, T(0.));
+            std::copy(h, h + m, _buf.begin());
+            _fwd->execute(_buf.data(), _H.data());
+        }
+
+        size_t kernel_size() const
+        {
+            return _m;
+        }
+
+        /*! @brief FFTの長さ．直接計算するときは0
+        */
+        size_t fft_size() const
+        {
+            return _L;
+        }
+
+        bool direct() const
+        {
+            return _direct;
+        }
+
+        const T *kernel() const
+        {
+            return _h.data();
+        }
+
+        /*! @brief 長さnの系列xとの線形畳み込みをoutに書く
+            @param out n + m - 1個の領域
+        */
+        void apply(const T *x, const size_t n, T *out)
+        {
+            std::fill(out, out + n + _m - 1, T(0.));
+            if (_direct) {
+                for (size_t i = 0; i < n; i++) {
+                    for (size_t j = 0; j < _m; j++) {
+                        out[i + j] += detail::mul(x[i], _h[j]);
+                    }
+                }
+
+                return;
+            }
+
+            // 重畳加算法．長さB = L - m + 1ずつ区切って畳み込み，ずらして足す
+            const size_t B = _L - _m + 1;
+            for (size_t begin = 0; begin < n; begin += B) {
+                const size_t len = std::min(B, n - begin);
+                std::copy(x + begin, x + begin + len, _buf.begin());
+                std::fill(_buf.begin() + len, _buf.end(), T(0.));
+                circular(_buf.data(), _buf.data());
+                const size_t valid = len + _m - 1;
+                for (size_t t = 0; t < valid; t++) {
+                    out[begin + t] += _buf[t];
+                }
+            }
+        }
+
+        /*! @brief 長さfft_size()の系列とカーネルの巡回畳み込み．outはinと重なってもよい
+        */
+        void circular(const T *in, T *out)
+        {
+            _fwd->execute(in, _spec.data());
+            // 実数の逆変換は半分のスペクトルしか読まない
+            const size_t bins = std::is_complex <T>::value ? _L : _L / 2 + 1;
+            for (size_t k = 0; k < bins; k++) {
+                _spec[k] = detail::mul(_spec[k], _H[k]);
+            }
+            _inv->execute(_spec.data(), out);
+        }
+    };
+
+    template <typename T>
+    std::atomic <size_t> Convolver <T>::direct_limit(32);
+
+    /*! @class
+        @brief 因果的なFIRフィルタ y_t = sum_j h_j x_{t - j}．重畳保留法で少しずつ流れてくる系列に掛ける
+        @tparam T 実数型または複素数型
+        入力をB = L - m + 1個ずつ溜めてから出力するので，出力は最大B - 1個遅れる
+    */
+    template <typename T>
+    class FIR_filter {
+    private:
+        Convolver <T>   _conv;
+        const size_t    _m;
+        const size_t    _L; // ブロック全体の長さ．直前のm - 1個と新しいB個
+        const size_t    _B;
+        std::vector <T> _buf;
+        std::vector <T> _res;
+        size_t          _fill; // 溜まった新しい標本の数
+    public:
+        /*! @param h カーネル
+            @param m カーネル長（1以上）
+            @param block 1ブロックの新しい標本数の下限．0のときFFTの長さから決める
+        */
+        FIR_filter(const T *h, const size_t m, const size_t block = 0)
+            : _conv(h, m, (block == 0) ? 0 : block + m - 1), _m(m),
+            _L(_conv.direct() ? std::max(block, 4 * m) + m - 1 : _conv.fft_size()), _B(_L - m + 1), _buf(_L), _res(_L)
+        {
+            reset();
+        }
+
+        /*! @brief 出力が遅れる最大の標本数 + 1
+        */
+        size_t block_size() const
+        {
+            return _B;
+        }
+
+        /*! @brief count個の標本を受け取り，揃ったブロックの出力をoutに書く
+            @param out count + block_size() - 1個の領域
+            @return 書いた標本数
+        */
+        size_t push(const T *x, const size_t count, T *out)
+        {
+            size_t written = 0;
+            for (size_t i = 0; i < count; ) {
+                const size_t len = std::min(_B - _fill, count - i);
+                std::copy(x + i, x + i + len, _buf.begin() + (_m - 1) + _fill);
+                _fill += len;
+                i     += len;
+                if (_fill == _B) {
+                    filter(out + written, _B);
+                    written += _B;
+                }
+            }
+
+            return written;
+        }
+
+        /*! @brief 溜まっている標本の出力を書き，最初の状態に戻す
+            @param out block_size() - 1個の領域
+            @return 書いた標本数
+        */
+        size_t flush(T *out)
+        {
+            const size_t written = _fill;
+            if (_fill > 0) {
+                std::fill(_buf.begin() + (_m - 1) + _fill, _buf.end(), T(0.));
+                filter(out, _fill);
+            }
+            reset();
+
+            return written;
+        }
+
+        /*! @brief 受け取った標本を捨てて最初の状態に戻す
+        */
+        void reset()
+        {
+            std::fill(_buf.begin(), _buf.end(), T(0.));
+            _fill = 0;
+        }
+
+    private:
+        // _bufのブロックの先頭count個の出力を書き，最後のm - 1個を次のブロックの先頭に送る
+        void filter(T *out, const size_t count)
+        {
+            if (_conv.direct()) {
+                const T *h = _conv.kernel();
+                for (size_t t = 0; t < count; t++) {
+                    T sum(0.);
+                    for (size_t j = 0; j < _m; j++) {
+                        sum += detail::mul(h[j], _buf[_m - 1 + t - j]);
+                    }
+                    out[t] = sum;
+                }
+            } else {
+                // 巡回畳み込みの先頭m - 1個は折り返しで壊れている
+                _conv.circular(_buf.data(), _res.data());
+                std::copy(_res.begin() + (_m - 1), _res.begin() + (_m - 1) + count, out);
+            }
+            std::copy(_buf.end() - (_m - 1), _buf.end(), _buf.begin());
+            _fill = 0;
+        }
+    };
+
+    /*! @brief 線形畳み込み (x * y)_k = sum_i x_i y_{k - i}
+        @param out n + m - 1個の領域
+        短い方をカーネルにする．両方長ければFFT 1回，長さが大きく違えば重畳加算法になる
+    */
+    template <typename T>
+    void convolve(const T *x, const size_t n, const T *y, const size_t m, T *out)
+    {
+        if (n == 0 || m == 0) {
+            return;
+        }
+        if (n < m) {
+            convolve(y, m, x, n, out);
+
+            return;
+        }
+        Convolver <T> convolver(y, m, std::min(n + m - 1, 4 * m));
+        convolver.apply(x, n, out);
+    }
+
+    /*! @brief std::vector用．長さはn + m - 1
+    */
+    template <typename T>
+    std::vector <T> convolve(const std::vector <T> &x, const std::vector <T> &y)
+    {
+        if (x.empty() || y.empty()) {
+            return std::vector <T>();
+        }
+        std::vector <T> retval(x.size() + y.size() - 1);
+        convolve(x.data(), x.size(), y.data(), y.size(), retval.data());
+
+        return retval;
+    }
+
+    /*! @brief 巡回畳み込み．長さN = max(n, m)で，短い方は0で埋める
+        一方が空ならN個の0を返す
+    */
+    template <typename T>
+    std::vector <T> circular_convolve(const std::vector <T> &x, const std::vector <T> &y)
+    {
+        const std::vector <T> linear = convolve(x, y);
+        const size_t          N      = std::max(x.size(), y.size());
+        std::vector <T>       retval(N, T(0.));
+        for (size_t k = 0; k < linear.size(); k++) {
+            retval[k % N] += linear[k];
+        }
+
+        return retval;
+    }
+
+    /*! @brief 相互相関 r_k = sum_t x_{t + k} conj(y_t)，k = -(m - 1), ..., n - 1
+        @return 長さn + m - 1．第k + m - 1要素がずれkの値
+    */
+    template <typename T>
+    std::vector <T> correlate(const std::vector <T> &x, const std::vector <T> &y)
+    {
+        std::vector <T> reversed(y.size());
+        std::transform(y.rbegin(), y.rend(), reversed.begin(), [](const T &a){return detail::conjugate(a);});
+
+        return convolve(x, reversed);
+    }
+
+    /*! @brief 巡回相互相関 r_k = sum_t x_{(t + k) mod N} conj(y_t)，k = 0, ..., N - 1
+        長さN = max(n, m)で，短い方は0で埋める．一方が空ならN個の0を返す
+    */
+    template <typename T>
+    std::vector <T> circular_correlate(const std::vector <T> &x, const std::vector <T> &y)
+    {
+        const std::vector <T> linear = correlate(x, y);
+        const size_t          n      = x.size();
+        const size_t          m      = y.size();
+        const size_t          N      = std::max(n, m);
+        std::vector <T>       retval(N, T(0.));
+        if (linear.empty()) {
+            return retval;
+        }
+        for (size_t k = 0; k < N; k++) {
+            // ずれkとk - N
+            if (k < n) {
+                retval[k] += linear[k + m - 1];
+            }
+            if (k + m > N) {
+                retval[k] += linear[k + m - 1 - N];
+            }
+        }
+
+        return retval;
+    }
+
+    /*! @brief 長さnの系列について直接計算とFFTの速さをカーネル長ごとに比べ，Convolver<T>::direct_limitを決め直す
+        @return 新しいdirect_limit
+        測っている間はdirect_limitを変えないので，他のスレッドのConvolverに影響しない
+    */
+    template <typename T>
+    size_t calibrate_convolution(const size_t n = 1 << 14, const size_t max_kernel = 1024)
+    {
+        using clock = std::chrono::steady_clock;
+        std::vector <T> x(n), out;
+        for (size_t t = 0; t < n; t++) {
+            x[t] = T(std::sin(0.1 * t));
+        }
+        const auto time = [&](const std::vector <T> &h, const size_t limit) {
+                              Convolver <T> convolver(h.data(), h.size(), 0, limit);
+                              out.resize(n + h.size() - 1);
+                              const auto    start = clock::now();
+                              convolver.apply(x.data(), n, out.data());
+
+                              return std::chrono::duration <double>(clock::now() - start).count();
+                          };
+
+        size_t limit = 0;
+        for (size_t m = 2; m <= max_kernel; m *= 2) {
+            const std::vector <T> h(x.begin(), x.begin() + std::min(m, n));
+            if (time(h, m) > time(h, 0)) {
+                break;
+            }
+            limit = m;
+        }
+        Convolver <T>::direct_limit = limit;
+
+        return limit;
+    }
+}
+
+#endif
@@ -20,6 +20,7 @@ namespace util {
         @param x 関数1（std::array）
         @param y 関数2（std::array）
         @return x*y
+        系列全体の畳み込みはutil_convのconvolve（FFT）を使う
     */
     template <typename T, size_t n>
     T conv(const std::array<T, n>& x, const std::array<T, n>& y)